@@ -1,16 +1,85 @@
 set -xe
 
-CC="clang"
-CFLAGS="-std=c2x -Wall -Wextra -Wpedantic -g -O0 -DDEBUG_MODE -I./src -fPIC"
-RAYLIB_FLAGS="$(pkg-config --libs --cflags raylib)"
+# NOTE: ./build.sh cli builds only the headless binary, it does not need raylib. ./build.sh bench
+# builds the microbenchmarks optimized and runs them, BENCH_ARGS is passed through.
+#
+# PROFILE picks the configuration:
+#   debug    -O0 with asserts, the default
+#   release  -O2 and LTO, no asserts
+#   pgo      release, plus an instrumented build of the CLI and the benchmarks that is trained on
+#            the benchmark corpus before the optimized rebuild. The app is not trained, it is built
+#            as release.
+# LTO_FLAGS overrides -flto, set it empty when the linker has no LTO plugin.
+TARGET="${1:-all}"
+PROFILE="${PROFILE:-debug}"
+
+CC="${CC:-clang}"
+BASE_CFLAGS="-std=c2x -Wall -Wextra -Wpedantic -I./src -pthread"
+RELEASE_FLAGS="-g -O2 ${LTO_FLAGS--flto}"
+
+case "$PROFILE" in
+    debug) OPT_FLAGS="-g -O0 -DDEBUG_MODE" ;;
+    release|pgo) OPT_FLAGS="$RELEASE_FLAGS" ;;
+    *) echo "unknown PROFILE '$PROFILE', expected debug, release or pgo" >&2; exit 2 ;;
+esac
+
+CFLAGS="$BASE_CFLAGS $OPT_FLAGS -fPIC"
+# NOTE: the benchmarks are always optimized, numbers from a debug build are meaningless
+BENCH_CFLAGS="$BASE_CFLAGS $RELEASE_FLAGS -DARENA_STATS"
 BUILD_DIR="./build"
+PGO_DIR="$BUILD_DIR/pgo"
 PROGRAM="logic-sim"
 ENTRY="./src/main.c"
 GAME_ENTRY="./src/game.c"
+CLI_PROGRAM="logic-sim-cli"
+CLI_ENTRY="./src/cli.c"
+BENCH_PROGRAM="logic-sim-bench"
+BENCH_ENTRY="./src/bench.c"
 
 mkdir -p $BUILD_DIR
 
-$CC $CFLAGS -shared $GAME_ENTRY -o "$BUILD_DIR/game.so.tmp" $RAYLIB_FLAGS
-mv "$BUILD_DIR/game.so.tmp" "$BUILD_DIR/game.so"
+PGO_USE=""
+if [ "$PROFILE" = "pgo" ] && [ "$TARGET" != "gui" ]; then
+    rm -rf "$PGO_DIR"
+    mkdir -p "$PGO_DIR"
+
+    # NOTE: profiles are matched by object name with gcc, so the instrumented binaries are built at
+    # the same paths as the final ones and overwritten afterwards
+    if $CC --version | grep -q clang; then
+        PGO_GENERATE="-fprofile-instr-generate=$PGO_DIR/%m.profraw"
+        PGO_USE="-fprofile-instr-use=$PGO_DIR/default.profdata -Wno-profile-instr-unprofiled"
+    else
+        PGO_GENERATE="-fprofile-generate=$PGO_DIR -fprofile-update=atomic"
+        PGO_USE="-fprofile-use=$PGO_DIR -fprofile-partial-training -Wno-missing-profile"
+    fi
+
+    $CC $CFLAGS $PGO_GENERATE -o "$BUILD_DIR/$CLI_PROGRAM" $CLI_ENTRY
+    $CC $BENCH_CFLAGS $PGO_GENERATE -o "$BUILD_DIR/$BENCH_PROGRAM" $BENCH_ENTRY
+
+    # NOTE: the minimizers only get the small expressions, the exact one is exponential
+    "$BUILD_DIR/$BENCH_PROGRAM" -t 1 -n 1 > /dev/null
+    "$BUILD_DIR/$BENCH_PROGRAM" -p | "$BUILD_DIR/$CLI_PROGRAM" -t > /dev/null
+    "$BUILD_DIR/$BENCH_PROGRAM" -p | head -n 4 | "$BUILD_DIR/$CLI_PROGRAM" -s > /dev/null
+
+    if $CC --version | grep -q clang; then
+        llvm-profdata merge -o "$PGO_DIR/default.profdata" "$PGO_DIR"/*.profraw
+    fi
+fi
+
+if [ "$TARGET" = "all" ] || [ "$TARGET" = "gui" ]; then
+    RAYLIB_FLAGS="$(pkg-config --libs --cflags raylib)"
+
+    $CC $CFLAGS -shared $GAME_ENTRY -o "$BUILD_DIR/game.so.tmp" $RAYLIB_FLAGS
+    mv "$BUILD_DIR/game.so.tmp" "$BUILD_DIR/game.so"
+
+    $CC $CFLAGS -o "$BUILD_DIR/$PROGRAM" $ENTRY $RAYLIB_FLAGS -ldl
+fi
+
+if [ "$TARGET" = "all" ] || [ "$TARGET" = "cli" ]; then
+    $CC $CFLAGS $PGO_USE -o "$BUILD_DIR/$CLI_PROGRAM" $CLI_ENTRY
+fi
 
-$CC $CFLAGS -o "$BUILD_DIR/$PROGRAM" $ENTRY $RAYLIB_FLAGS -ldl
+if [ "$TARGET" = "bench" ]; then
+    $CC $BENCH_CFLAGS $PGO_USE -o "$BUILD_DIR/$BENCH_PROGRAM" $BENCH_ENTRY
+    "$BUILD_DIR/$BENCH_PROGRAM" $BENCH_ARGS
+fi
@@ -12,6 +12,11 @@ InitializeArena(memory_arena *arena, usize size, void *base)
     arena->used = 0;
     arena->capacity = size - sizeof(*first_block);
     arena->minimum_block_size = 0;
+    arena->free_blocks = 0;
+
+    memset(&arena->stats, 0, sizeof(arena->stats));
+    arena->stats.block_count = 1;
+    arena->stats.peak_block_count = 1;
 }
 
 internal inline usize
@@ -41,6 +46,34 @@ ZeroSize(void *ptr, usize size)
 #define PushStruct(a, type) (type *)PushSize_((a), sizeof(type), alignof(type))
 #define PushSize(a, size) PushSize_((a), (size), alignof(max_align_t))
 
+internal inline void
+RecordArenaPush(memory_arena *arena, usize size_init, usize alignment_offset)
+{
+    if (!ARENA_STATS_ENABLED)
+        return;
+
+    arena_stats *stats = &arena->stats;
+    stats->push_count += 1;
+    stats->bytes_pushed += size_init;
+    stats->alignment_bytes += alignment_offset;
+    stats->peak_used = Max(stats->peak_used, stats->retired_used + arena->used);
+
+    usize bucket = 0;
+    while (bucket + 1 < ARENA_HISTOGRAM_BUCKETS && ((usize)2 << bucket) <= size_init)
+        bucket += 1;
+    stats->histogram[bucket] += 1;
+}
+
+internal inline void
+RecordArenaRewind(memory_arena *arena)
+{
+    if (!ARENA_STATS_ENABLED)
+        return;
+
+    arena->stats.retired_used = 0;
+    arena->stats.block_count = 1;
+}
+
 internal void *
 PushSizeResize_(memory_arena *arena, usize size_init, usize alignment)
 {
@@ -52,7 +85,30 @@ PushSizeResize_(memory_arena *arena, usize size_init, usize alignment)
     usize size = GetEffectiveSize(arena, size_init, alignment);
     usize block_size = Max(size + header_size, arena->minimum_block_size);
 
-    memory_block *new_block = Platform.AllocateMemory(block_size);
+    memory_block *new_block = NULL;
+    for (memory_block **link = &arena->free_blocks; *link; link = &(*link)->prev) {
+        if ((*link)->size >= size_init + alignment + header_size) {
+            new_block = *link;
+            *link = new_block->prev;
+            block_size = new_block->size;
+            break;
+        }
+    }
+
+    if (ARENA_STATS_ENABLED) {
+        arena_stats *stats = &arena->stats;
+        stats->retired_used += arena->used;
+        stats->block_count += 1;
+        stats->peak_block_count = Max(stats->peak_block_count, stats->block_count);
+        stats->blocks_reused += new_block ? 1 : 0;
+        stats->blocks_allocated += new_block ? 0 : 1;
+    }
+
+    if (!new_block) {
+        TraceBlock("AllocateArenaBlock", "size", block_size, NULL, 0) {
+            new_block = Platform.AllocateMemory(block_size);
+        }
+    }
     Assert(new_block);
 
     new_block->prev = arena->current_block;
@@ -70,6 +126,7 @@ PushSizeResize_(memory_arena *arena, usize size_init, usize alignment)
     arena->used += size;
 
     Assert(size >= size_init);
+    RecordArenaPush(arena, size_init, alignment_offset);
 
     return result;
 }
@@ -86,6 +143,7 @@ PushSize_(memory_arena *arena, usize size_init, usize alignment)
         arena->used += size;
 
         Assert(size >= size_init);
+        RecordArenaPush(arena, size_init, alignment_offset);
 
         return result;
     }
@@ -93,7 +151,7 @@ PushSize_(memory_arena *arena, usize size_init, usize alignment)
     return PushSizeResize_(arena, size_init, alignment);
 }
 
-internal char *
+maybe_unused internal char *
 PushString(memory_arena *arena, const char *source)
 {
     usize size = strlen(source);
@@ -127,14 +185,28 @@ EndTemporaryMemory(temporary_memory temp_mem)
 }
 
 internal void
+ReleaseFreeBlocks(memory_arena *arena)
+{
+    while (arena->free_blocks) {
+        memory_block *block = arena->free_blocks;
+        arena->free_blocks = block->prev;
+        Platform.DeallocateMemory(block, block->size);
+        arena->stats.blocks_freed += 1;
+    }
+}
+
+maybe_unused internal void
 ArenaReset(memory_arena *arena)
 {
+    ReleaseFreeBlocks(arena);
+
     while (arena->current_block->prev != 0) {
         memory_block *to_free = arena->current_block;
         memory_block *prev_block = to_free->prev;
 
         arena->current_block = prev_block;
         Platform.DeallocateMemory(to_free, to_free->size);
+        arena->stats.blocks_freed += 1;
     }
 
     memory_block *root = arena->current_block;
@@ -143,11 +215,36 @@ ArenaReset(memory_arena *arena)
     arena->used = 0;
     arena->capacity = root->size - sizeof(memory_block);
     arena->temp_count = 0;
+    RecordArenaRewind(arena);
 }
 
+// NOTE(fcasibu): ArenaReset that keeps the grown blocks for the next round instead of handing them
+// back, an arena reused per item stops hitting the platform once it has seen its largest item
 internal void
+ArenaRecycle(memory_arena *arena)
+{
+    while (arena->current_block->prev != 0) {
+        memory_block *block = arena->current_block;
+        arena->current_block = block->prev;
+
+        block->prev = arena->free_blocks;
+        arena->free_blocks = block;
+    }
+
+    memory_block *root = arena->current_block;
+
+    arena->base = (u8 *)root + sizeof(memory_block);
+    arena->used = 0;
+    arena->capacity = root->size - sizeof(memory_block);
+    arena->temp_count = 0;
+    RecordArenaRewind(arena);
+}
+
+maybe_unused internal void
 FreeArena(memory_arena *arena)
 {
+    ReleaseFreeBlocks(arena);
+
     memory_block *block = arena->current_block;
     while (block) {
         memory_block *prev = block->prev;
@@ -158,6 +255,65 @@ FreeArena(memory_arena *arena)
     ZeroStruct(arena);
 }
 
+// NOTE(fcasibu): without ARENA_STATS earlier blocks of the chain count as full, the arena does not
+// remember how much of them was left over
+internal usize
+GetArenaUsed(const memory_arena *arena)
+{
+    if (ARENA_STATS_ENABLED)
+        return arena->stats.retired_used + arena->used;
+
+    usize result = arena->used;
+    for (memory_block *block = arena->current_block->prev; block; block = block->prev)
+        result += block->size - sizeof(memory_block);
+
+    return result;
+}
+
+internal void
+PrintByteCount(FILE *out, usize bytes)
+{
+    if (bytes >= MB(1)) {
+        fprintf(out, "%.1f MB", (f64)bytes / MB(1));
+    } else if (bytes >= KB(1)) {
+        fprintf(out, "%.1f KB", (f64)bytes / KB(1));
+    } else {
+        fprintf(out, "%zu B", bytes);
+    }
+}
+
+// NOTE(fcasibu): does nothing unless built with ARENA_STATS
+maybe_unused internal void
+PrintArenaStats(FILE *out, const char *name, const memory_arena *arena)
+{
+    if (!ARENA_STATS_ENABLED)
+        return;
+
+    const arena_stats *stats = &arena->stats;
+
+    fprintf(out, "arena %s: peak ", name);
+    PrintByteCount(out, stats->peak_used);
+    fprintf(out, " over %zu blocks, %zu pushes of ", stats->peak_block_count, stats->push_count);
+    PrintByteCount(out, stats->bytes_pushed);
+    fprintf(out, ", ");
+    PrintByteCount(out, stats->alignment_bytes);
+    fprintf(out, " lost to alignment\n");
+
+    fprintf(out, "  blocks: %zu allocated, %zu reused, %zu freed\n", stats->blocks_allocated,
+            stats->blocks_reused, stats->blocks_freed);
+
+    for (usize i = 0; i < ARENA_HISTOGRAM_BUCKETS; ++i) {
+        if (!stats->histogram[i])
+            continue;
+
+        fprintf(out, "  [");
+        PrintByteCount(out, (usize)1 << i);
+        fprintf(out, ", ");
+        PrintByteCount(out, (usize)2 << i);
+        fprintf(out, "): %zu\n", stats->histogram[i]);
+    }
+}
+
 #define GrowArray(arena, da)                                                         \
     do {                                                                             \
         typedef typeof(*(da)->items) element_type;                                   \
@@ -174,6 +330,7 @@ FreeArena(memory_arena *arena)
             usize growth = (new_cap - old_cap) * element_size;                       \
             if ((arena)->used + growth <= (arena)->capacity) {                       \
                 (arena)->used += growth;                                             \
+                RecordArenaPush((arena), growth, 0);                                 \
                 (da)->capacity = new_cap;                                            \
             } else {                                                                 \
                 element_type *new_items = PushArray((arena), new_cap, element_type); \
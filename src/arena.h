@@ -1,6 +1,35 @@
 #ifndef ARENA_H
 #define ARENA_H
 
+// NOTE(fcasibu): build with -DARENA_STATS to have every arena record its usage, PrintArenaStats
+// dumps it
+#ifdef ARENA_STATS
+#define ARENA_STATS_ENABLED 1
+#else
+#define ARENA_STATS_ENABLED 0
+#endif
+
+// NOTE(fcasibu): push sizes are bucketed by power of two, bucket i holds [2^i, 2^(i + 1))
+#define ARENA_HISTOGRAM_BUCKETS 40
+
+typedef struct {
+    // NOTE(fcasibu): bytes left behind in earlier blocks of the chain, used across the whole
+    // chain is retired_used + used
+    usize retired_used;
+    usize peak_used;
+
+    usize block_count;
+    usize peak_block_count;
+    usize blocks_allocated;
+    usize blocks_reused;
+    usize blocks_freed;
+
+    usize push_count;
+    usize bytes_pushed;
+    usize alignment_bytes;
+    usize histogram[ARENA_HISTOGRAM_BUCKETS];
+} arena_stats;
+
 typedef struct memory_block {
     struct memory_block *prev;
     usize size;
@@ -13,7 +42,12 @@ typedef struct {
     usize capacity;
     usize minimum_block_size;
 
+    // NOTE(fcasibu): blocks ArenaRecycle kept around, reused before asking the platform for more
+    memory_block *free_blocks;
+
     usize temp_count;
+
+    arena_stats stats;
 } memory_arena;
 
 typedef struct {
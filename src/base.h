@@ -39,6 +39,10 @@ typedef ptrdiff_t isize;
 #define local_const static const
 #define global_const static const
 
+// NOTE(fcasibu): every target is a single translation unit, this marks the functions that only
+// some of them call
+#define maybe_unused [[maybe_unused]]
+
 #define B(x) (x)
 #define KB(x) ((x) << 10)
 #define MB(x) ((x) << 20)
@@ -0,0 +1,125 @@
+#include <pthread.h>
+
+typedef struct {
+    engine *engine;
+    const char **sources;
+    usize count;
+    column_order columns;
+
+    batch_slot slots[BATCH_PIPELINE_DEPTH];
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} batch_pipeline;
+
+internal void
+CompileBatchItem(batch_pipeline *p, batch_slot *slot, usize item_idx)
+{
+    TraceBlock("CompileBatchItem", "item", item_idx, NULL, 0) {
+        ArenaRecycle(&slot->arena);
+        slot->parsed = CompileExpression(p->engine, &slot->arena, p->sources[item_idx],
+                                         p->columns, &slot->expression);
+    }
+}
+
+internal void
+SetBatchSlotState(batch_pipeline *p, batch_slot *slot, batch_slot_state state)
+{
+    pthread_mutex_lock(&p->lock);
+    slot->state = state;
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->lock);
+}
+
+// NOTE(fcasibu): traced so pipeline stalls show up as gaps between the two threads
+internal void
+WaitForBatchSlot(batch_pipeline *p, batch_slot *slot, batch_slot_state state)
+{
+    TraceBlock("WaitForBatchSlot", "state", state, NULL, 0) {
+        pthread_mutex_lock(&p->lock);
+        while (slot->state != state)
+            pthread_cond_wait(&p->changed, &p->lock);
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+internal void *
+BatchFrontEndThread(void *param)
+{
+    batch_pipeline *p = (batch_pipeline *)param;
+
+    for (usize i = 0; i < p->count; ++i) {
+        batch_slot *slot = &p->slots[i % BATCH_PIPELINE_DEPTH];
+
+        WaitForBatchSlot(p, slot, BatchSlot_Free);
+        CompileBatchItem(p, slot, i);
+        SetBatchSlotState(p, slot, BatchSlot_Compiled);
+    }
+
+    return NULL;
+}
+
+// NOTE(fcasibu): Interpret over many sources. Parsing and lowering item N + 1 runs on its own
+// thread while item N is evaluated here, each slot keeps its arena blocks between items so after
+// the first few the pipeline stops allocating.
+internal void
+InterpretBatch(engine *e, memory_arena *arena, const char **sources, usize count,
+               column_order columns, batch_item_sink *Sink, void *user)
+{
+    Assert(e);
+    Assert(arena);
+    Assert(sources || count == 0);
+    Assert(Sink);
+
+    batch_pipeline *p = PushStruct(arena, batch_pipeline);
+    p->engine = e;
+    p->sources = sources;
+    p->count = count;
+    p->columns = columns;
+
+    for (usize i = 0; i < BATCH_PIPELINE_DEPTH; ++i) {
+        batch_slot *slot = &p->slots[i];
+        InitializeArena(&slot->arena, BATCH_ARENA_SIZE, PushSize(arena, BATCH_ARENA_SIZE));
+        slot->state = BatchSlot_Free;
+    }
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->changed, NULL);
+
+    // NOTE(fcasibu): without the thread every item is compiled inline right before it is evaluated
+    pthread_t front_end;
+    b32 pipelined = count > 1 && pthread_create(&front_end, NULL, BatchFrontEndThread, p) == 0;
+
+    for (usize i = 0; i < count; ++i) {
+        batch_slot *slot = &p->slots[i % BATCH_PIPELINE_DEPTH];
+
+        if (pipelined) {
+            WaitForBatchSlot(p, slot, BatchSlot_Compiled);
+        } else {
+            CompileBatchItem(p, slot, i);
+        }
+
+        eval_result result = { Eval_ParseError, { NULL } };
+        if (slot->parsed) {
+            truth_table *table = EvaluateExpression(e, &slot->arena, &slot->expression);
+            result = (eval_result){ Eval_Ok, { table } };
+        }
+
+        TraceBlock("BatchItemSink", "item", i, NULL, 0) {
+            Sink(user, &slot->arena, i, result);
+        }
+
+        if (pipelined)
+            SetBatchSlotState(p, slot, BatchSlot_Free);
+    }
+
+    if (pipelined)
+        pthread_join(front_end, NULL);
+
+    pthread_cond_destroy(&p->changed);
+    pthread_mutex_destroy(&p->lock);
+
+    for (usize i = 0; i < BATCH_PIPELINE_DEPTH; ++i) {
+        PrintArenaStats(stderr, "batch slot", &p->slots[i].arena);
+        ArenaReset(&p->slots[i].arena);
+    }
+}
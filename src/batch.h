@@ -0,0 +1,27 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// NOTE(fcasibu): items in flight at once, one being compiled while the one before it is evaluated
+#define BATCH_PIPELINE_DEPTH 2
+#define BATCH_ARENA_SIZE MB(16)
+
+// NOTE(fcasibu): called on the evaluating thread in item order, the arena belongs to the item and
+// is recycled once this returns so nothing in result may be kept past it
+#define BATCH_ITEM_SINK(name)                                                                      \
+    void name(void *user, memory_arena *arena, usize item_idx, eval_result result)
+typedef BATCH_ITEM_SINK(batch_item_sink);
+
+typedef Enum(u8, batch_slot_state){
+    BatchSlot_Free,
+    BatchSlot_Compiled,
+};
+
+typedef struct {
+    memory_arena arena;
+    compiled_expression expression;
+    b32 parsed;
+
+    batch_slot_state state;
+} batch_slot;
+
+#endif // BATCH_H
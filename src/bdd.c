@@ -0,0 +1,638 @@
+// https://en.wikipedia.org/wiki/Binary_decision_diagram
+
+internal void
+ClearBddCache(bdd_manager *m)
+{
+    for (usize i = 0; i < m->cache_size; ++i)
+        m->cache[i].op = ~(u32)0;
+}
+
+internal void
+ResizeBddCache(bdd_manager *m, usize cache_size)
+{
+    m->cache_size = cache_size;
+    m->cache = PushArray(m->arena, cache_size, bdd_cache_entry);
+    Assert(m->cache);
+
+    ClearBddCache(m);
+}
+
+internal void
+InitializeBddManager(memory_arena *arena, bdd_manager *m, usize var_count)
+{
+    Assert(arena);
+    Assert(m);
+    Assert(var_count <= MAX_VARS);
+
+    m->arena = arena;
+    m->var_count = (u32)var_count;
+    m->overflowed = false;
+    m->epoch = 0;
+    m->reorder_threshold = BDD_REORDER_THRESHOLD;
+
+    for (u32 i = 0; i < var_count; ++i) {
+        m->level_of[i] = i;
+        m->var_at[i] = i;
+    }
+
+    ArrayInit(arena, &m->nodes, 1024);
+
+    // NOTE(fcasibu): the terminals live in slots 0 and 1 so refs can be compared against them
+    // directly
+    bdd_node terminal = { .var = (u32)var_count };
+    ArrayPush(arena, &m->nodes, terminal);
+    terminal.lo = terminal.hi = BDD_TRUE;
+    ArrayPush(arena, &m->nodes, terminal);
+
+    m->bucket_count = 1024;
+    m->buckets = PushArray(arena, m->bucket_count, u32);
+    ZeroArray(m->bucket_count, m->buckets);
+
+    ResizeBddCache(m, BDD_MIN_CACHE_SIZE);
+}
+
+internal inline b32
+IsBddTerminal(bdd_ref f)
+{
+    return f <= BDD_TRUE;
+}
+
+internal inline u32
+GetBddLevel(const bdd_manager *m, bdd_ref f)
+{
+    return IsBddTerminal(f) ? m->var_count : m->level_of[m->nodes.items[f].var];
+}
+
+internal inline u32
+HashBddNode(u32 var, bdd_ref lo, bdd_ref hi)
+{
+    u64 h = ((u64)var * 0x9E3779B97F4A7C15ULL) ^ lo;
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ hi;
+    h *= 0x9E3779B97F4A7C15ULL;
+
+    return (u32)(h >> 32);
+}
+
+internal void
+RehashBddNodes(bdd_manager *m, usize bucket_count)
+{
+    m->bucket_count = bucket_count;
+    m->buckets = PushArray(m->arena, bucket_count, u32);
+    ZeroArray(bucket_count, m->buckets);
+
+    for (usize i = BDD_TRUE + 1; i < m->nodes.size; ++i) {
+        bdd_node *node = &m->nodes.items[i];
+        u32 bucket = HashBddNode(node->var, node->lo, node->hi) & (bucket_count - 1);
+
+        node->next_in_bucket = m->buckets[bucket];
+        m->buckets[bucket] = (u32)i;
+    }
+
+    if (m->cache_size < Min(bucket_count, BDD_MAX_CACHE_SIZE))
+        ResizeBddCache(m, Min(bucket_count, BDD_MAX_CACHE_SIZE));
+}
+
+// NOTE(fcasibu): the unique table keeps one node per (var, lo, hi), so equal functions share a
+// ref and redundant tests never get a node
+internal bdd_ref
+MakeBddNode(bdd_manager *m, u32 var, bdd_ref lo, bdd_ref hi)
+{
+    if (lo == hi)
+        return lo;
+
+    u32 bucket = HashBddNode(var, lo, hi) & (m->bucket_count - 1);
+
+    for (u32 i = m->buckets[bucket]; i; i = m->nodes.items[i].next_in_bucket) {
+        bdd_node *node = &m->nodes.items[i];
+        if (node->var == var && node->lo == lo && node->hi == hi)
+            return i;
+    }
+
+    if (m->nodes.size >= BDD_MAX_NODES) {
+        m->overflowed = true;
+        return BDD_FALSE;
+    }
+
+    bdd_node node = { .var = var, .lo = lo, .hi = hi, .next_in_bucket = m->buckets[bucket] };
+    bdd_ref result = (bdd_ref)m->nodes.size;
+    ArrayPush(m->arena, &m->nodes, node);
+    m->buckets[bucket] = result;
+
+    if (m->nodes.size > m->bucket_count)
+        RehashBddNodes(m, m->bucket_count * 2);
+
+    return result;
+}
+
+internal inline bdd_ref
+GetBddVar(bdd_manager *m, u32 var)
+{
+    Assert(var < m->var_count);
+    return MakeBddNode(m, var, BDD_FALSE, BDD_TRUE);
+}
+
+internal inline void
+GetBddCofactors(const bdd_manager *m, bdd_ref f, u32 level, bdd_ref *lo, bdd_ref *hi)
+{
+    if (GetBddLevel(m, f) != level) {
+        *lo = *hi = f;
+        return;
+    }
+
+    *lo = m->nodes.items[f].lo;
+    *hi = m->nodes.items[f].hi;
+}
+
+// NOTE(fcasibu): the cases that need no recursion, returns false when there is none
+internal inline b32
+TryBddShortcut(op_code op, bdd_ref f, bdd_ref g, bdd_ref *out)
+{
+    if (IsBddTerminal(f) && IsBddTerminal(g)) {
+        *out = ApplyOp(op, (u8)f, (u8)g);
+        return true;
+    }
+
+    switch (op) {
+        case OP_And: {
+            if (f == BDD_FALSE || g == BDD_FALSE) {
+                *out = BDD_FALSE;
+                return true;
+            }
+            if (f == BDD_TRUE || f == g) {
+                *out = g;
+                return true;
+            }
+            if (g == BDD_TRUE) {
+                *out = f;
+                return true;
+            }
+        } break;
+
+        case OP_Or: {
+            if (f == BDD_TRUE || g == BDD_TRUE) {
+                *out = BDD_TRUE;
+                return true;
+            }
+            if (f == BDD_FALSE || f == g) {
+                *out = g;
+                return true;
+            }
+            if (g == BDD_FALSE) {
+                *out = f;
+                return true;
+            }
+        } break;
+
+        case OP_Xor: {
+            if (f == g) {
+                *out = BDD_FALSE;
+                return true;
+            }
+            if (f == BDD_FALSE) {
+                *out = g;
+                return true;
+            }
+            if (g == BDD_FALSE) {
+                *out = f;
+                return true;
+            }
+        } break;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+internal bdd_ref
+ApplyBdd(bdd_manager *m, op_code op, bdd_ref f, bdd_ref g)
+{
+    if (m->overflowed)
+        return BDD_FALSE;
+
+    bdd_ref result;
+    if (TryBddShortcut(op, f, g, &result))
+        return result;
+
+    if (IsCommutative(op) && f > g) {
+        bdd_ref t = f;
+        f = g;
+        g = t;
+    }
+
+    u32 slot = HashBddNode(op, f, g) & (m->cache_size - 1);
+    bdd_cache_entry *entry = &m->cache[slot];
+    if (entry->op == op && entry->f == f && entry->g == g)
+        return entry->result;
+
+    u32 level = Min(GetBddLevel(m, f), GetBddLevel(m, g));
+    bdd_ref f_lo, f_hi, g_lo, g_hi;
+    GetBddCofactors(m, f, level, &f_lo, &f_hi);
+    GetBddCofactors(m, g, level, &g_lo, &g_hi);
+
+    bdd_ref lo = ApplyBdd(m, op, f_lo, g_lo);
+    bdd_ref hi = ApplyBdd(m, op, f_hi, g_hi);
+    result = MakeBddNode(m, m->var_at[level], lo, hi);
+
+    entry->op = op;
+    entry->f = f;
+    entry->g = g;
+    entry->result = result;
+
+    return result;
+}
+
+internal inline bdd_ref
+NegateBdd(bdd_manager *m, bdd_ref f)
+{
+    return ApplyBdd(m, OP_Xor, f, BDD_TRUE);
+}
+
+internal usize
+MarkBddNodes(bdd_manager *m, bdd_ref f)
+{
+    if (IsBddTerminal(f) || m->nodes.items[f].epoch == m->epoch)
+        return 0;
+
+    m->nodes.items[f].epoch = m->epoch;
+    return 1 + MarkBddNodes(m, m->nodes.items[f].lo) + MarkBddNodes(m, m->nodes.items[f].hi);
+}
+
+// NOTE(fcasibu): reordering never frees anything, the size that matters is what the roots reach
+internal usize
+CountLiveBddNodes(bdd_manager *m, const bdd_ref *roots, usize root_count)
+{
+    m->epoch += 1;
+
+    usize count = 0;
+    for (usize i = 0; i < root_count; ++i)
+        count += MarkBddNodes(m, roots[i]);
+
+    return count;
+}
+
+internal bdd_ref
+CopyBddNode(bdd_manager *m, bdd_nodes *nodes, bdd_ref f, u32 *remap)
+{
+    if (IsBddTerminal(f))
+        return f;
+
+    if (remap[f])
+        return remap[f];
+
+    bdd_node node = m->nodes.items[f];
+    node.lo = CopyBddNode(m, nodes, node.lo, remap);
+    node.hi = CopyBddNode(m, nodes, node.hi, remap);
+
+    remap[f] = (u32)nodes->size;
+    ArrayPush(m->arena, nodes, node);
+
+    return remap[f];
+}
+
+// NOTE(fcasibu): moves the nodes the roots reach into a fresh array and drops the rest, the
+// roots are rewritten in place and the cache is cleared since its refs are stale
+internal void
+CompactBdd(bdd_manager *m, bdd_ref *roots, usize root_count)
+{
+    usize live = CountLiveBddNodes(m, roots, root_count);
+
+    u32 *remap = PushArray(m->arena, m->nodes.size, u32);
+    ZeroArray(m->nodes.size, remap);
+
+    bdd_nodes nodes;
+    ArrayInit(m->arena, &nodes, Max(live + BDD_TRUE + 1, 1024));
+    ArrayPush(m->arena, &nodes, m->nodes.items[BDD_FALSE]);
+    ArrayPush(m->arena, &nodes, m->nodes.items[BDD_TRUE]);
+
+    for (usize i = 0; i < root_count; ++i)
+        roots[i] = CopyBddNode(m, &nodes, roots[i], remap);
+
+    m->nodes = nodes;
+
+    usize bucket_count = 1024;
+    while (bucket_count < m->nodes.size)
+        bucket_count *= 2;
+    RehashBddNodes(m, bucket_count);
+
+    ClearBddCache(m);
+}
+
+internal void
+UnlinkBddNode(bdd_manager *m, bdd_ref f)
+{
+    const bdd_node *node = &m->nodes.items[f];
+    u32 *link = &m->buckets[HashBddNode(node->var, node->lo, node->hi) & (m->bucket_count - 1)];
+
+    while (*link != f)
+        link = &m->nodes.items[*link].next_in_bucket;
+
+    *link = node->next_in_bucket;
+}
+
+internal void
+LinkBddNode(bdd_manager *m, bdd_ref f)
+{
+    bdd_node *node = &m->nodes.items[f];
+    u32 bucket = HashBddNode(node->var, node->lo, node->hi) & (m->bucket_count - 1);
+
+    node->next_in_bucket = m->buckets[bucket];
+    m->buckets[bucket] = f;
+}
+
+// NOTE(fcasibu): swaps the variables at level and level + 1. An x node that tests y below it is
+// rewritten in place into a y node over two fresh x nodes, so every ref keeps its function and
+// nothing above the two levels has to change.
+internal void
+SwapBddLevels(bdd_manager *m, u32 level)
+{
+    Assert(level + 1 < m->var_count);
+
+    u32 x = m->var_at[level];
+    u32 y = m->var_at[level + 1];
+
+    // NOTE(fcasibu): the x nodes made below only point under both levels, they never need a rewrite
+    usize count = m->nodes.size;
+
+    for (usize i = BDD_TRUE + 1; i < count && !m->overflowed; ++i) {
+        bdd_node node = m->nodes.items[i];
+        if (node.var != x)
+            continue;
+
+        b32 lo_tests_y = !IsBddTerminal(node.lo) && m->nodes.items[node.lo].var == y;
+        b32 hi_tests_y = !IsBddTerminal(node.hi) && m->nodes.items[node.hi].var == y;
+        if (!lo_tests_y && !hi_tests_y)
+            continue;
+
+        bdd_ref f00 = lo_tests_y ? m->nodes.items[node.lo].lo : node.lo;
+        bdd_ref f01 = lo_tests_y ? m->nodes.items[node.lo].hi : node.lo;
+        bdd_ref f10 = hi_tests_y ? m->nodes.items[node.hi].lo : node.hi;
+        bdd_ref f11 = hi_tests_y ? m->nodes.items[node.hi].hi : node.hi;
+
+        bdd_ref lo = MakeBddNode(m, x, f00, f10);
+        bdd_ref hi = MakeBddNode(m, x, f01, f11);
+
+        UnlinkBddNode(m, (bdd_ref)i);
+        m->nodes.items[i].var = y;
+        m->nodes.items[i].lo = lo;
+        m->nodes.items[i].hi = hi;
+        LinkBddNode(m, (bdd_ref)i);
+    }
+
+    m->var_at[level] = y;
+    m->var_at[level + 1] = x;
+    m->level_of[x] = level + 1;
+    m->level_of[y] = level;
+}
+
+// NOTE(fcasibu): Rudell's sifting, each variable (busiest first) is moved through every level
+// and left where the live diagram was smallest
+// https://en.wikipedia.org/wiki/Binary_decision_diagram#Variable_ordering
+internal void
+SiftBdd(bdd_manager *m, bdd_ref *roots, usize root_count)
+{
+    Assert(m);
+
+    if (m->overflowed || m->var_count < 2)
+        return;
+
+    CompactBdd(m, roots, root_count);
+    if (m->nodes.size > BDD_SIFT_MAX_NODES)
+        return;
+
+    u32 order[MAX_VARS];
+    usize var_nodes[MAX_VARS] = { 0 };
+    for (usize i = BDD_TRUE + 1; i < m->nodes.size; ++i)
+        var_nodes[m->nodes.items[i].var] += 1;
+
+    for (u32 i = 0; i < m->var_count; ++i) {
+        u32 j = i;
+        for (; j > 0 && var_nodes[order[j - 1]] < var_nodes[i]; --j)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    usize size = CountLiveBddNodes(m, roots, root_count);
+
+    for (u32 i = 0; i < m->var_count && !m->overflowed; ++i) {
+        u32 var = order[i];
+        usize best_size = size;
+        u32 best_level = m->level_of[var];
+
+        // NOTE(fcasibu): head for the nearer end first so the way back is the longer sweep
+        b32 down_first = m->level_of[var] >= m->var_count / 2;
+
+        for (u32 pass = 0; pass < 2 && !m->overflowed; ++pass) {
+            b32 down = (pass == 0) == down_first;
+
+            while (!m->overflowed) {
+                u32 level = m->level_of[var];
+                if (down ? level + 1 >= m->var_count : level == 0)
+                    break;
+
+                SwapBddLevels(m, down ? level : level - 1);
+                size = CountLiveBddNodes(m, roots, root_count);
+
+                if (size < best_size) {
+                    best_size = size;
+                    best_level = m->level_of[var];
+                }
+
+                if (size * 100 > best_size * BDD_SIFT_MAX_GROWTH)
+                    break;
+            }
+        }
+
+        while (!m->overflowed && m->level_of[var] < best_level)
+            SwapBddLevels(m, m->level_of[var]);
+        while (!m->overflowed && m->level_of[var] > best_level)
+            SwapBddLevels(m, m->level_of[var] - 1);
+
+        CompactBdd(m, roots, root_count);
+        size = m->nodes.size - (BDD_TRUE + 1);
+    }
+}
+
+// NOTE(fcasibu): renumbers the chunk variables so variable i is the one at level i, after this
+// the truth table columns follow the sifted order
+internal void
+ApplyBddOrder(bdd_manager *m, chunk *c)
+{
+    Assert(c->vars.size == m->var_count);
+
+    if (m->overflowed)
+        return;
+
+    var sorted[MAX_VARS];
+    for (u32 i = 0; i < m->var_count; ++i)
+        sorted[i] = c->vars.items[m->var_at[i]];
+    for (u32 i = 0; i < m->var_count; ++i)
+        c->vars.items[i] = sorted[i];
+
+    for (u8 *ip = c->items; ip < c->items + c->size; ip += GetInstructionSize(*ip)) {
+        if (*ip == OP_Var || GetBinaryOp(*ip))
+            ip[1] = (u8)m->level_of[ip[1]];
+    }
+
+    for (usize i = BDD_TRUE + 1; i < m->nodes.size; ++i)
+        m->nodes.items[i].var = m->level_of[m->nodes.items[i].var];
+
+    for (u32 i = 0; i < m->var_count; ++i) {
+        m->level_of[i] = i;
+        m->var_at[i] = i;
+    }
+}
+
+// NOTE(fcasibu): replays the stack code with BDDs on the stack, BDD_FALSE with overflowed set
+// when the diagram outgrew BDD_MAX_NODES
+internal bdd_ref
+BuildBdd(bdd_manager *m, const chunk *c)
+{
+    Assert(m);
+    Assert(c);
+    Assert(c->vars.size == m->var_count);
+
+    if (c->size == 0)
+        return BDD_FALSE;
+
+    bdd_ref *stack = PushArray(m->arena, c->size, bdd_ref);
+    bdd_ref slots[MAX_SLOTS] = { 0 };
+    usize depth = 0;
+
+    u8 *ip = c->items;
+    u8 *end = c->items + c->size;
+
+    while (ip < end && !m->overflowed) {
+        op_code op = *ip++;
+
+        switch (op) {
+            case OP_Var: {
+                stack[depth++] = GetBddVar(m, *ip++);
+            } break;
+
+            case OP_Load: {
+                stack[depth++] = slots[*ip++];
+            } break;
+
+            case OP_Store: {
+                slots[*ip++] = stack[depth - 1];
+            } break;
+
+            case OP_False:
+            case OP_True: {
+                stack[depth++] = op == OP_True ? BDD_TRUE : BDD_FALSE;
+            } break;
+
+            case OP_Not: {
+                stack[depth - 1] = NegateBdd(m, stack[depth - 1]);
+            } break;
+
+            case OP_AndVar:
+            case OP_OrVar:
+            case OP_XorVar:
+            case OP_XnorVar:
+            case OP_NandVar:
+            case OP_NorVar:
+            case OP_ImplyVar: {
+                bdd_ref var = GetBddVar(m, *ip++);
+                stack[depth - 1] = ApplyBdd(m, GetBinaryOp(op), stack[depth - 1], var);
+            } break;
+
+            default: {
+                depth -= 1;
+                stack[depth - 1] = ApplyBdd(m, op, stack[depth - 1], stack[depth]);
+            } break;
+        }
+
+        // NOTE(fcasibu): everything still on the stack or in a slot is a root, the threshold
+        // doubles past whatever sifting left so a bad order cannot keep triggering it
+        if (m->nodes.size > m->reorder_threshold && !m->overflowed) {
+            usize root_count = depth + MAX_SLOTS;
+            bdd_ref *roots = PushArray(m->arena, root_count, bdd_ref);
+            memcpy(roots, stack, depth * sizeof(*roots));
+            memcpy(roots + depth, slots, sizeof(slots));
+
+            SiftBdd(m, roots, root_count);
+
+            memcpy(stack, roots, depth * sizeof(*roots));
+            memcpy(slots, roots + depth, sizeof(slots));
+            m->reorder_threshold = Max(m->reorder_threshold, m->nodes.size * 2);
+        }
+    }
+
+    return m->overflowed ? BDD_FALSE : stack[0];
+}
+
+// NOTE(fcasibu): the overflowed flag of the result is set when the diagram outgrew BDD_MAX_NODES
+internal bdd_manager *
+BuildSiftedBdd(memory_arena *arena, const chunk *c, bdd_ref *root)
+{
+    Assert(arena);
+    Assert(c);
+    Assert(root);
+
+    bdd_manager *m = PushStruct(arena, bdd_manager);
+    InitializeBddManager(arena, m, c->vars.size);
+    *root = BuildBdd(m, c);
+    SiftBdd(m, root, 1);
+
+    return m;
+}
+
+internal u64
+CountBddPaths(const bdd_manager *m, bdd_ref f, u64 *memo)
+{
+    if (IsBddTerminal(f))
+        return f;
+
+    if (memo[f] != ~(u64)0)
+        return memo[f];
+
+    const bdd_node *node = &m->nodes.items[f];
+    u32 level = GetBddLevel(m, f);
+    u64 lo = CountBddPaths(m, node->lo, memo) << (GetBddLevel(m, node->lo) - level - 1);
+    u64 hi = CountBddPaths(m, node->hi, memo) << (GetBddLevel(m, node->hi) - level - 1);
+
+    memo[f] = lo + hi;
+    return memo[f];
+}
+
+// NOTE(fcasibu): number of rows where f is true
+internal u64
+GetBddSatCount(bdd_manager *m, bdd_ref f)
+{
+    Assert(m->var_count < 64);
+
+    u64 *memo = PushArray(m->arena, m->nodes.size, u64);
+    memset(memo, 0xFF, m->nodes.size * sizeof(*memo));
+
+    return CountBddPaths(m, f, memo) << GetBddLevel(m, f);
+}
+
+// NOTE(fcasibu): 64 rows at once, variables past the word are fixed by word_idx, the ones inside
+// it blend both branches through their pattern
+internal u64
+GetBddTruthWord(const bdd_manager *m, bdd_ref f, u64 word_idx)
+{
+    while (!IsBddTerminal(f)) {
+        const bdd_node *node = &m->nodes.items[f];
+
+        if (node->var < 6) {
+            u64 pattern = VAR_PATTERNS[node->var];
+            return (pattern & GetBddTruthWord(m, node->hi, word_idx)) |
+                   (~pattern & GetBddTruthWord(m, node->lo, word_idx));
+        }
+
+        f = ((word_idx >> (node->var - 6)) & 1) ? node->hi : node->lo;
+    }
+
+    return f == BDD_TRUE ? ~(u64)0 : 0;
+}
+
+internal void
+GetBddTruthWords(const bdd_manager *m, bdd_ref f, u64 first_word, usize word_count, u64 *out)
+{
+    for (usize i = 0; i < word_count; ++i)
+        out[i] = GetBddTruthWord(m, f, first_word + i);
+}
@@ -0,0 +1,69 @@
+#ifndef BDD_H
+#define BDD_H
+
+// NOTE(fcasibu): reduced ordered BDD, refs index into the node array and 0/1 are the terminals
+typedef u32 bdd_ref;
+
+#define BDD_FALSE 0
+#define BDD_TRUE 1
+
+// NOTE(fcasibu): building gives up past this many nodes, the dense table is the fallback
+#define BDD_MAX_NODES (1 << 22)
+
+// NOTE(fcasibu): the computed cache starts small and grows with the unique table, most expressions
+// never need more than the first size and clearing the full one dominated small evaluations
+#define BDD_MIN_CACHE_SIZE (1 << 10)
+#define BDD_MAX_CACHE_SIZE (1 << 16)
+
+// NOTE(fcasibu): sifting only runs below BDD_SIFT_MAX_NODES live nodes and stops moving a
+// variable once the diagram grows past BDD_SIFT_MAX_GROWTH percent of the best size seen
+#define BDD_SIFT_MAX_NODES (1 << 18)
+#define BDD_SIFT_MAX_GROWTH 120
+#define BDD_REORDER_THRESHOLD 4096
+
+typedef struct {
+    u32 var;
+    bdd_ref lo;
+    bdd_ref hi;
+    u32 next_in_bucket;
+    u32 epoch;
+} bdd_node;
+
+typedef struct {
+    bdd_node *items;
+    usize size;
+    usize capacity;
+} bdd_nodes;
+
+typedef struct {
+    u32 op;
+    bdd_ref f;
+    bdd_ref g;
+    bdd_ref result;
+} bdd_cache_entry;
+
+// NOTE(fcasibu): levels are the variable order, level_of[var] and var_at[level] are inverses.
+// Terminals sit below every variable at level var_count.
+typedef struct {
+    memory_arena *arena;
+
+    bdd_nodes nodes;
+    u32 *buckets;
+    usize bucket_count;
+
+    bdd_cache_entry *cache;
+    usize cache_size;
+
+    u32 var_count;
+    u32 level_of[MAX_VARS];
+    u32 var_at[MAX_VARS];
+
+    // NOTE(fcasibu): live nodes are the ones marked with the current epoch, building sifts once
+    // the node array passes reorder_threshold
+    u32 epoch;
+    usize reorder_threshold;
+
+    b32 overflowed;
+} bdd_manager;
+
+#endif // BDD_H
@@ -0,0 +1,529 @@
+// NOTE(fcasibu): microbenchmarks over a generated corpus, the corpus only depends on the seed so
+// runs of different builds can be diffed. Built with ARENA_STATS so allocations can be counted.
+#define _DEFAULT_SOURCE
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#include "base.h"
+#include "arena.h"
+#include "platform.h"
+#include "trace.h"
+#include "profiler.h"
+
+#include "intern.h"
+#include "lexer.h"
+#include "jit.h"
+#include "chunk.h"
+#include "compiler.h"
+#include "bdd.h"
+#include "scheduler.h"
+#include "vm.h"
+#include "espresso.h"
+
+#include "trace.c"
+#include "arena.c"
+#include "profiler.c"
+#include "intern.c"
+#include "lexer.c"
+#include "chunk.c"
+#include "compiler.c"
+#include "optimizer.c"
+#include "scheduler.c"
+#include "jit.c"
+#include "bdd.c"
+#include "espresso.c"
+#include "vm.c"
+
+#include "platform_posix.c"
+
+#define BENCH_ARENA_SIZE MB(64)
+#define BENCH_DEFAULT_SEED 0x5EED
+#define BENCH_DEFAULT_SAMPLES 5
+#define BENCH_DEFAULT_SAMPLE_MS 20
+
+typedef struct {
+    u32 var_count;
+    u32 op_count;
+} bench_shape;
+
+// NOTE(fcasibu): growing in both directions, the minimizers are only run on the shapes they can
+// finish in a reasonable time. Past a few hundred operators random expressions blow up the BDD
+// and compile dominates the whole run.
+global_const bench_shape BENCH_SHAPES[] = {
+    { 4, 16 }, { 8, 64 }, { 10, 128 }, { 12, 256 }, { 16, 256 }, { 20, 512 },
+};
+
+typedef struct {
+    bench_shape shape;
+    const char *source;
+
+    engine *engine;
+    compiled_expression expression;
+    truth_table *table;
+    vm vm;
+
+    u64 *words;
+} bench_case;
+
+#define BENCH_PROC(name) void name(bench_case *bc, memory_arena *arena)
+typedef BENCH_PROC(bench_proc);
+
+typedef struct {
+    const char *name;
+    bench_proc *Proc;
+    u32 max_vars;
+    b32 counts_rows;
+} bench_def;
+
+typedef Enum(u8, bench_format){
+    BenchFormat_Text,
+    BenchFormat_Csv,
+    BenchFormat_Json,
+};
+
+typedef struct {
+    const char *name;
+    bench_shape shape;
+
+    u64 iterations;
+    f64 ns_per_op;
+    f64 min_ns_per_op;
+    f64 rows_per_sec;
+    f64 allocs_per_op;
+    f64 bytes_per_op;
+} bench_result;
+
+// NOTE(fcasibu): results are folded in here so the optimizer cannot drop the work
+global volatile u64 BenchSink;
+
+// NOTE(fcasibu): xorshift64*, deterministic across platforms unlike rand()
+internal inline u64
+NextRandom(u64 *state)
+{
+    u64 x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+typedef struct {
+    char *items;
+    usize size;
+    usize capacity;
+} bench_text;
+
+internal void
+AppendText(memory_arena *arena, bench_text *text, const char *str)
+{
+    for (; *str; ++str)
+        ArrayPush(arena, text, *str);
+}
+
+global_const char *BENCH_OPERATORS[] = { "AND", "OR", "XOR", "XNOR", "NAND", "NOR", "IMPLY" };
+
+// NOTE(fcasibu): a random tree with op_count binary operators, the first leaves walk a shuffled
+// variable list so every variable shows up
+internal void
+GenerateTree(memory_arena *arena, bench_text *text, u64 *rng, u32 op_count, const u32 *perm,
+             u32 var_count, u32 *leaf_idx)
+{
+    if (NextRandom(rng) % 8 == 0)
+        AppendText(arena, text, "NOT ");
+
+    if (op_count == 0) {
+        u32 leaf = *leaf_idx;
+        *leaf_idx += 1;
+
+        u32 var = leaf < var_count ? perm[leaf] : (u32)(NextRandom(rng) % var_count);
+        char name[16];
+        snprintf(name, sizeof(name), "V%u", var);
+        AppendText(arena, text, name);
+        return;
+    }
+
+    u32 left_ops = (u32)(NextRandom(rng) % op_count);
+
+    AppendText(arena, text, "(");
+    GenerateTree(arena, text, rng, left_ops, perm, var_count, leaf_idx);
+    AppendText(arena, text, " ");
+    AppendText(arena, text, BENCH_OPERATORS[NextRandom(rng) % ArrayCount(BENCH_OPERATORS)]);
+    AppendText(arena, text, " ");
+    GenerateTree(arena, text, rng, op_count - 1 - left_ops, perm, var_count, leaf_idx);
+    AppendText(arena, text, ")");
+}
+
+internal const char *
+GenerateExpression(memory_arena *arena, u64 *rng, bench_shape shape)
+{
+    Assert(shape.var_count <= MAX_VARS && shape.op_count + 1 >= shape.var_count);
+
+    u32 perm[MAX_VARS];
+    for (u32 i = 0; i < shape.var_count; ++i)
+        perm[i] = i;
+
+    for (u32 i = shape.var_count; i > 1; --i) {
+        u32 j = (u32)(NextRandom(rng) % i);
+        u32 t = perm[i - 1];
+        perm[i - 1] = perm[j];
+        perm[j] = t;
+    }
+
+    bench_text text;
+    ArrayInit(arena, &text, 256);
+
+    u32 leaf_idx = 0;
+    GenerateTree(arena, &text, rng, shape.op_count, perm, shape.var_count, &leaf_idx);
+    ArrayPush(arena, &text, '\0');
+
+    return text.items;
+}
+
+internal
+BENCH_PROC(BenchLex)
+{
+    (void)arena;
+
+    lexer l;
+    InitializeLexer(&l, bc->source);
+
+    u64 count = 0;
+    while (ScanToken(&l).kind != TokenKind_Eof)
+        count += 1;
+
+    BenchSink += count;
+}
+
+internal
+BENCH_PROC(BenchParse)
+{
+    engine *e = bc->engine;
+
+    chunk c = { 0 };
+    InitializeChunk(arena, &c, 2048);
+    InitializeStringInternPool(&e->strings, arena, 10);
+    e->parser.strings = &e->strings;
+
+    BenchSink += Parse(&e->parser, arena, &c, bc->source) ? c.size : 0;
+}
+
+internal
+BENCH_PROC(BenchCompile)
+{
+    compiled_expression expression;
+    BenchSink += CompileExpression(bc->engine, arena, bc->source, Columns_Source, &expression);
+}
+
+// NOTE(fcasibu): the scalar stack interpreter on its own, no threads and no JIT
+internal
+BENCH_PROC(BenchRunVM)
+{
+    (void)arena;
+
+    RunVM(&bc->vm, 0, bc->table->results.size, bc->words);
+    BenchSink += bc->words[0];
+}
+
+// NOTE(fcasibu): whatever SelectVMKernel or the JIT would pick, single threaded
+internal
+BENCH_PROC(BenchKernel)
+{
+    (void)arena;
+
+    chunk *c = &bc->expression.chunk;
+    if (c->native) {
+        c->native(0, bc->table->results.size, bc->words);
+    } else {
+        bc->vm.Kernel(&bc->vm, 0, bc->table->results.size, bc->words);
+    }
+
+    BenchSink += bc->words[0];
+}
+
+internal
+BENCH_PROC(BenchTruthTable)
+{
+    truth_table *table = GetTruthTable(&bc->vm, arena);
+    BenchSink += table->results.items[0];
+}
+
+internal
+BENCH_PROC(BenchPrimeImplicants)
+{
+    implicants *primes = FindPrimeImplicants(arena, bc->table);
+    BenchSink += primes->size;
+}
+
+internal
+BENCH_PROC(BenchSimplify)
+{
+    const char *simplified = SimplifyExpression(arena, bc->table, Minimizer_Auto);
+    BenchSink += simplified ? strlen(simplified) : 0;
+}
+
+internal
+BENCH_PROC(BenchSimplifyHeuristic)
+{
+    const char *simplified = SimplifyExpression(arena, bc->table, Minimizer_Heuristic);
+    BenchSink += simplified ? strlen(simplified) : 0;
+}
+
+// clang-format off
+global_const bench_def BENCHMARKS[] = {
+    { "lex",                BenchLex,               MAX_VARS, false },
+    { "parse",              BenchParse,             MAX_VARS, false },
+    { "compile",            BenchCompile,           MAX_VARS, false },
+    { "run_vm",             BenchRunVM,             MAX_VARS, true  },
+    { "kernel",             BenchKernel,            MAX_VARS, true  },
+    { "truth_table",        BenchTruthTable,        MAX_VARS, true  },
+    { "prime_implicants",   BenchPrimeImplicants,   10,       false },
+    { "simplify",           BenchSimplify,          10,       false },
+    { "simplify_heuristic", BenchSimplifyHeuristic, 12,       false },
+};
+// clang-format on
+
+// NOTE(fcasibu): the first sample calibrates how many iterations fill sample_ms, the reported
+// ns/op is the median sample so one noisy sample does not move it
+internal bench_result
+RunBenchmark(const bench_def *def, bench_case *bc, memory_arena *arena, usize samples,
+             u64 sample_ms)
+{
+    bench_result result = { .name = def->name, .shape = bc->shape };
+
+    ArenaRecycle(arena);
+    def->Proc(bc, arena);
+
+    u64 iterations = 1;
+    u64 sample_ns = sample_ms * 1000000ULL;
+
+    for (;;) {
+        u64 start = ReadMonotonicNanoseconds();
+        for (u64 i = 0; i < iterations; ++i) {
+            ArenaRecycle(arena);
+            def->Proc(bc, arena);
+        }
+        u64 elapsed = ReadMonotonicNanoseconds() - start;
+
+        if (elapsed >= sample_ns / 4 || iterations >= ((u64)1 << 32))
+            break;
+
+        iterations *= 2;
+    }
+
+    f64 sample_results[64];
+    samples = Max(Min(samples, ArrayCount(sample_results)), 1);
+
+    arena_stats before = arena->stats;
+
+    for (usize s = 0; s < samples; ++s) {
+        u64 start = ReadMonotonicNanoseconds();
+        for (u64 i = 0; i < iterations; ++i) {
+            ArenaRecycle(arena);
+            def->Proc(bc, arena);
+        }
+        sample_results[s] = (f64)(ReadMonotonicNanoseconds() - start) / (f64)iterations;
+    }
+
+    for (usize i = 1; i < samples; ++i) {
+        f64 v = sample_results[i];
+        usize j = i;
+        for (; j > 0 && sample_results[j - 1] > v; --j)
+            sample_results[j] = sample_results[j - 1];
+        sample_results[j] = v;
+    }
+
+    u64 total = iterations * samples;
+    result.iterations = total;
+    result.ns_per_op = sample_results[samples / 2];
+    result.min_ns_per_op = sample_results[0];
+    result.allocs_per_op = (f64)(arena->stats.push_count - before.push_count) / (f64)total;
+    result.bytes_per_op = (f64)(arena->stats.bytes_pushed - before.bytes_pushed) / (f64)total;
+
+    if (def->counts_rows)
+        result.rows_per_sec = (f64)bc->table->row_count * 1e9 / result.ns_per_op;
+
+    return result;
+}
+
+internal void
+PrintBenchHeader(bench_format format)
+{
+    switch (format) {
+        case BenchFormat_Text: {
+            printf("%-20s %5s %6s %14s %14s %14s %10s %12s\n", "benchmark", "vars", "ops",
+                   "ns/op", "min ns/op", "rows/s", "allocs/op", "bytes/op");
+        } break;
+
+        case BenchFormat_Csv: {
+            printf("benchmark,vars,ops,iterations,ns_per_op,min_ns_per_op,rows_per_sec,"
+                   "allocs_per_op,bytes_per_op\n");
+        } break;
+
+        case BenchFormat_Json: {
+            printf("[\n");
+        } break;
+    }
+}
+
+internal void
+PrintBenchResult(bench_format format, const bench_result *r, b32 first)
+{
+    switch (format) {
+        case BenchFormat_Text: {
+            printf("%-20s %5u %6u %14.1f %14.1f %14.4g %10.1f %12.1f\n", r->name, r->shape.var_count,
+                   r->shape.op_count, r->ns_per_op, r->min_ns_per_op, r->rows_per_sec,
+                   r->allocs_per_op, r->bytes_per_op);
+        } break;
+
+        case BenchFormat_Csv: {
+            printf("%s,%u,%u,%llu,%.1f,%.1f,%.1f,%.2f,%.1f\n", r->name, r->shape.var_count,
+                   r->shape.op_count, (unsigned long long)r->iterations, r->ns_per_op,
+                   r->min_ns_per_op, r->rows_per_sec, r->allocs_per_op, r->bytes_per_op);
+        } break;
+
+        case BenchFormat_Json: {
+            printf("%s  {\"benchmark\": \"%s\", \"vars\": %u, \"ops\": %u, \"iterations\": %llu, "
+                   "\"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f, \"rows_per_sec\": %.1f, "
+                   "\"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}",
+                   first ? "" : ",\n", r->name, r->shape.var_count, r->shape.op_count,
+                   (unsigned long long)r->iterations, r->ns_per_op, r->min_ns_per_op,
+                   r->rows_per_sec, r->allocs_per_op, r->bytes_per_op);
+        } break;
+    }
+
+    fflush(stdout);
+}
+
+internal void
+PrintUsage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [-f text|csv|json] [-b filter] [-s seed] [-n samples] [-t sample_ms] [-p]\n"
+            "  -f  output format (default text)\n"
+            "  -b  only run benchmarks whose name contains filter\n"
+            "  -s  corpus seed (default %d)\n"
+            "  -n  samples per benchmark, the median is reported (default %d)\n"
+            "  -t  target milliseconds per sample (default %d)\n"
+            "  -p  print the corpus one expression per line instead of running\n",
+            program, BENCH_DEFAULT_SEED, BENCH_DEFAULT_SAMPLES, BENCH_DEFAULT_SAMPLE_MS);
+}
+
+int
+main(int argc, char **argv)
+{
+    Platform.AllocateMemory = AllocateMemory;
+    Platform.DeallocateMemory = DeallocateMemory;
+    Platform.ProtectMemory = ProtectMemory;
+
+    bench_format format = BenchFormat_Text;
+    const char *filter = NULL;
+    u64 seed = BENCH_DEFAULT_SEED;
+    usize samples = BENCH_DEFAULT_SAMPLES;
+    u64 sample_ms = BENCH_DEFAULT_SAMPLE_MS;
+    b32 print_corpus = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:b:s:n:t:ph")) != -1) {
+        switch (opt) {
+            case 'f': {
+                if (strcmp(optarg, "text") == 0) {
+                    format = BenchFormat_Text;
+                } else if (strcmp(optarg, "csv") == 0) {
+                    format = BenchFormat_Csv;
+                } else if (strcmp(optarg, "json") == 0) {
+                    format = BenchFormat_Json;
+                } else {
+                    PrintUsage(argv[0]);
+                    return 2;
+                }
+            } break;
+
+            case 'b': {
+                filter = optarg;
+            } break;
+
+            case 's': {
+                seed = strtoull(optarg, NULL, 0);
+            } break;
+
+            case 'n': {
+                samples = (usize)strtoull(optarg, NULL, 0);
+            } break;
+
+            case 't': {
+                sample_ms = strtoull(optarg, NULL, 0);
+            } break;
+
+            case 'p': {
+                print_corpus = true;
+            } break;
+
+            default: {
+                PrintUsage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+            }
+        }
+    }
+
+    memory_arena setup;
+    memory_arena scratch;
+    InitializeArena(&setup, BENCH_ARENA_SIZE, AllocateMemory(BENCH_ARENA_SIZE));
+    InitializeArena(&scratch, BENCH_ARENA_SIZE, AllocateMemory(BENCH_ARENA_SIZE));
+
+    u64 rng = seed ? seed : 1;
+
+    // NOTE(fcasibu): the same expressions the benchmarks run, the PGO build trains the CLI on them
+    if (print_corpus) {
+        for (usize s = 0; s < ArrayCount(BENCH_SHAPES); ++s)
+            printf("%s\n", GenerateExpression(&setup, &rng, BENCH_SHAPES[s]));
+
+        FreeArena(&scratch);
+        FreeArena(&setup);
+        return 0;
+    }
+
+    engine *e = CreateEngine(&setup);
+
+    PrintBenchHeader(format);
+    b32 first = true;
+
+    for (usize s = 0; s < ArrayCount(BENCH_SHAPES); ++s) {
+        bench_case bc = { .shape = BENCH_SHAPES[s], .engine = e };
+        bc.source = GenerateExpression(&setup, &rng, bc.shape);
+
+        // NOTE(fcasibu): the later stages run on the compiled chunk and table built here, the
+        // JIT buffer holds one chunk at a time so it is compiled per shape
+        if (!CompileExpression(e, &setup, bc.source, Columns_Source, &bc.expression)) {
+            fprintf(stderr, "error: generated expression did not parse\n");
+            return 1;
+        }
+
+        bc.table = EvaluateExpression(e, &setup, &bc.expression);
+        InitializeVM(&bc.vm, &setup, &bc.expression.chunk);
+        bc.words = PushSize_(&setup, bc.table->results.size * sizeof(u64), 64);
+
+        for (usize b = 0; b < ArrayCount(BENCHMARKS); ++b) {
+            const bench_def *def = &BENCHMARKS[b];
+            if (bc.shape.var_count > def->max_vars)
+                continue;
+            if (filter && !strstr(def->name, filter))
+                continue;
+
+            bench_result result = RunBenchmark(def, &bc, &scratch, samples, sample_ms);
+            PrintBenchResult(format, &result, first);
+            first = false;
+        }
+    }
+
+    if (format == BenchFormat_Json)
+        printf("\n]\n");
+
+    ReleaseEngine(e);
+    FreeArena(&scratch);
+    FreeArena(&setup);
+
+    return 0;
+}
@@ -25,6 +25,112 @@ InitializeChunk(memory_arena *arena, chunk *c, usize initial_cap)
     InitializeVars(arena, &c->vars, 10);
 }
 
+internal inline usize
+GetInstructionSize(op_code op)
+{
+    switch (op) {
+        case OP_Var:
+        case OP_Load:
+        case OP_Store:
+        case OP_AndVar:
+        case OP_OrVar:
+        case OP_XorVar:
+        case OP_XnorVar:
+        case OP_NandVar:
+        case OP_NorVar:
+        case OP_ImplyVar:
+            return 2;
+
+        default:
+            return 1;
+    }
+}
+
+// NOTE(fcasibu): maps a binary operator to its superinstruction and back, 0 when there is none
+internal inline op_code
+GetVarOperandOp(op_code op)
+{
+    switch (op) {
+        case OP_And:
+            return OP_AndVar;
+        case OP_Or:
+            return OP_OrVar;
+        case OP_Xor:
+            return OP_XorVar;
+        case OP_Xnor:
+            return OP_XnorVar;
+        case OP_Nand:
+            return OP_NandVar;
+        case OP_Nor:
+            return OP_NorVar;
+        case OP_Imply:
+            return OP_ImplyVar;
+
+        default:
+            return 0;
+    }
+}
+
+internal inline op_code
+GetBinaryOp(op_code op)
+{
+    switch (op) {
+        case OP_AndVar:
+            return OP_And;
+        case OP_OrVar:
+            return OP_Or;
+        case OP_XorVar:
+            return OP_Xor;
+        case OP_XnorVar:
+            return OP_Xnor;
+        case OP_NandVar:
+            return OP_Nand;
+        case OP_NorVar:
+            return OP_Nor;
+        case OP_ImplyVar:
+            return OP_Imply;
+
+        default:
+            return 0;
+    }
+}
+
+// NOTE(fcasibu): entries an instruction pushes minus the ones it pops
+internal inline isize
+GetStackEffect(op_code op)
+{
+    switch (op) {
+        case OP_Var:
+        case OP_Load:
+        case OP_False:
+        case OP_True:
+            return 1;
+
+        case OP_Store:
+        case OP_Not:
+            return 0;
+
+        default:
+            return GetBinaryOp(op) ? 0 : -1;
+    }
+}
+
+internal usize
+GetMaxStackDepth(const chunk *c)
+{
+    Assert(c);
+
+    isize depth = 0;
+    isize max_depth = 0;
+
+    for (u8 *ip = c->items; ip < c->items + c->size; ip += GetInstructionSize(*ip)) {
+        depth += GetStackEffect(*ip);
+        max_depth = Max(max_depth, depth);
+    }
+
+    return (usize)max_depth;
+}
+
 internal inline void
 WriteChunk(memory_arena *arena, chunk *c, u8 byte)
 {
@@ -52,19 +158,19 @@ AddVar(memory_arena *arena, chunk *c, const char *name, usize intern_idx)
     if (c->vars.size >= c->vars.capacity)
         GrowArray(arena, &c->vars);
 
+    Assert(c->vars.size < MAX_VARS);
     c->vars.items[c->vars.size].name = name;
     c->vars.items[c->vars.size].index = intern_idx;
     return c->vars.size++;
 }
 
 internal inline void
-WriteVar(memory_arena *arena, chunk *c, const char *name, usize idx)
+WriteVar(memory_arena *arena, chunk *c, usize var_idx)
 {
     Assert(arena);
     Assert(c);
 
-    usize var_idx = AddVar(arena, c, name, idx);
-    Assert((var_idx + 1) <= 10);
+    Assert(var_idx < c->vars.size);
     WriteChunk(arena, c, OP_Var);
     WriteChunk(arena, c, var_idx);
 }
@@ -1,13 +1,28 @@
 #ifndef CHUNK_H
 #define CHUNK_H
 
+// NOTE(fcasibu): 2^32 rows is the most a truth table can address
+#define MAX_VARS 32
+
 // clang-format off
 typedef Enum(u8, op_code){
     OP_Var, OP_And, OP_Or, OP_Xor, OP_Xnor,
     OP_Not, OP_Nand, OP_Nor, OP_Imply,
+
+    // NOTE(fcasibu): OP_Store copies the top of the stack into a slot without popping it
+    OP_Load, OP_Store,
+
+    OP_False, OP_True,
+
+    // NOTE(fcasibu): superinstructions, <op> the top of the stack with the variable in the
+    // operand byte
+    OP_AndVar, OP_OrVar, OP_XorVar, OP_XnorVar,
+    OP_NandVar, OP_NorVar, OP_ImplyVar,
 };
 // clang-format on
 
+#define MAX_SLOTS 256
+
 typedef struct {
     const char *name;
     usize index;
@@ -19,12 +34,39 @@ typedef struct {
     usize capacity;
 } vars;
 
+// NOTE(fcasibu): registers [0, vars.size) hold the variables, temporaries follow
+#define MAX_REGISTERS 64
+
+typedef struct {
+    op_code op;
+    u8 dst;
+    u8 a;
+    u8 b;
+} instruction;
+
+typedef struct {
+    instruction *items;
+    usize size;
+    usize capacity;
+
+    u8 register_count;
+    u8 result;
+    b32 lowered;
+} register_chunk;
+
 typedef struct {
     u8 *items;
     usize size;
     usize capacity;
 
     vars vars;
+    usize slot_count;
+    // NOTE(fcasibu): deepest the stack code gets past the slots, set whenever it is emitted
+    usize max_depth;
+    register_chunk registers;
+
+    // NOTE(fcasibu): only set when the register code was compiled to machine code
+    jit_fn *native;
 } chunk;
 
 #endif // CHUNK_H
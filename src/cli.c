@@ -0,0 +1,325 @@
+// NOTE(fcasibu): headless entry point, same engine as game.c without raylib. Every non-empty line
+// of the inputs is an expression, lines starting with '#' are skipped.
+#define _DEFAULT_SOURCE
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#include "base.h"
+#include "arena.h"
+#include "platform.h"
+#include "trace.h"
+#include "profiler.h"
+
+#include "intern.h"
+#include "lexer.h"
+#include "jit.h"
+#include "chunk.h"
+#include "compiler.h"
+#include "bdd.h"
+#include "scheduler.h"
+#include "vm.h"
+#include "espresso.h"
+#include "batch.h"
+
+#include "trace.c"
+#include "arena.c"
+#include "profiler.c"
+#include "intern.c"
+#include "lexer.c"
+#include "chunk.c"
+#include "compiler.c"
+#include "optimizer.c"
+#include "scheduler.c"
+#include "jit.c"
+#include "bdd.c"
+#include "espresso.c"
+#include "vm.c"
+#include "batch.c"
+
+#include "platform_posix.c"
+
+#define CLI_ARENA_SIZE MB(64)
+
+typedef struct {
+    b32 print_table;
+    b32 print_count;
+    b32 print_simplified;
+    minimizer method;
+    column_order columns;
+    const char *trace_path;
+
+    memory_arena arena;
+    references sources;
+    b32 had_error;
+} cli_state;
+
+internal void
+PrintUsage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [-t] [-n] [-s] [-m auto|exact|heuristic] [-c source|sifted] [-e expr]... "
+            "[-T trace.json] [file|-]...\n"
+            "  -t  print the truth table\n"
+            "  -n  print how many rows are true\n"
+            "  -s  print the simplified expression\n"
+            "  -m  minimizer used by -s (default auto)\n"
+            "  -c  truth table column order (default source)\n"
+            "  -e  evaluate expr, may be repeated\n"
+            "  -T  write a Chrome trace-event file of the run\n"
+            "with none of -t, -n or -s the table and the simplified expression are printed, with "
+            "no expr or file stdin is read\n",
+            program);
+}
+
+// NOTE(fcasibu): one line per row, columns are as wide as their header so they line up
+internal void
+PrintTruthTable(memory_arena *arena, const truth_table *table)
+{
+    usize line_capacity = 8;
+    for (usize k = 0; k < table->vars.size; ++k)
+        line_capacity += strlen(table->vars.items[k]) + 1;
+
+    char *line = PushArray(arena, line_capacity, char);
+    Assert(line);
+
+    usize pos = 0;
+    for (usize k = 0; k < table->vars.size; ++k)
+        pos += sprintf(line + pos, "%s ", table->vars.items[k]);
+    pos += sprintf(line + pos, "| =\n");
+    fwrite(line, 1, pos, stdout);
+
+    // NOTE(fcasibu): only the digits move between rows, the padding is written once
+    memset(line, ' ', line_capacity);
+
+    // NOTE(fcasibu): a table that is only a BDD derives a block of words at a time
+    u64 *block = PushArray(arena, ROW_BLOCK_WORDS, u64);
+    const u64 *words = NULL;
+
+    for (u64 i = 0; i < table->row_count; ++i) {
+        u64 word_idx = i / 64;
+        if (i % (64 * ROW_BLOCK_WORDS) == 0) {
+            row_block range = GetRowBlock(GetRowWordCount(table->row_count),
+                                          word_idx / ROW_BLOCK_WORDS);
+            words = GetTruthWords(table, range.first_word, range.word_count, block);
+        }
+
+        pos = 0;
+        for (usize k = 0; k < table->vars.size; ++k) {
+            usize width = strlen(table->vars.items[k]);
+            line[pos] = ((i >> k) & 1) ? '1' : '0';
+            pos += width;
+            line[pos++] = ' ';
+        }
+
+        line[pos++] = '|';
+        line[pos++] = ' ';
+        line[pos++] = ((words[word_idx % ROW_BLOCK_WORDS] >> (i % 64)) & 1) ? '1' : '0';
+        line[pos++] = '\n';
+        fwrite(line, 1, pos, stdout);
+    }
+}
+
+internal void
+AddExpression(cli_state *state, const char *source)
+{
+    char *expression = PushString(&state->arena, source);
+    for (usize i = 0; expression[i]; ++i)
+        expression[i] = toupper(expression[i]);
+
+    ArrayPush(&state->arena, &state->sources, (const char *)expression);
+}
+
+internal void
+ReadExpressions(cli_state *state, FILE *file)
+{
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t length;
+
+    while ((length = getline(&line, &line_capacity, file)) != -1) {
+        while (length > 0 && isspace((u8)line[length - 1]))
+            line[--length] = 0;
+
+        char *source = line;
+        while (isspace((u8)*source))
+            ++source;
+
+        if (*source && *source != '#')
+            AddExpression(state, source);
+    }
+
+    free(line);
+}
+
+internal
+BATCH_ITEM_SINK(PrintExpression)
+{
+    cli_state *state = (cli_state *)user;
+    const char *source = state->sources.items[item_idx];
+
+    if (result.type != Eval_Ok) {
+        fprintf(stderr, "error: could not parse '%s'\n", source);
+        state->had_error = true;
+        return;
+    }
+
+    truth_table *table = result.value.table;
+    printf("%s\n", source);
+
+    if (state->print_table)
+        PrintTruthTable(arena, table);
+
+    if (state->print_count) {
+        printf("# %llu of %llu rows true\n", (unsigned long long)GetTrueRowCount(table),
+               (unsigned long long)table->row_count);
+    }
+
+    if (state->print_simplified) {
+        const char *simplified = SimplifyExpression(arena, table, state->method);
+        if (simplified) {
+            printf("= %s\n", simplified);
+        } else {
+            // NOTE(fcasibu): only the exact minimizer gives up, past QM_MAX_VARS
+            fprintf(stderr,
+                    "error: could not simplify '%s', the exact minimizer takes at most %d "
+                    "variables\n",
+                    source, QM_MAX_VARS);
+            state->had_error = true;
+        }
+    }
+
+    printf("\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    Platform.AllocateMemory = AllocateMemory;
+    Platform.DeallocateMemory = DeallocateMemory;
+    Platform.ProtectMemory = ProtectMemory;
+
+    cli_state state = { .method = Minimizer_Auto, .columns = Columns_Source };
+
+    void *base = AllocateMemory(CLI_ARENA_SIZE);
+    if (!base) {
+        fprintf(stderr, "error: could not allocate memory\n");
+        return 1;
+    }
+    InitializeArena(&state.arena, CLI_ARENA_SIZE, base);
+    ArrayInit(&state.arena, &state.sources, 64);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "tnsm:c:e:T:h")) != -1) {
+        switch (opt) {
+            case 't': {
+                state.print_table = true;
+            } break;
+
+            case 'n': {
+                state.print_count = true;
+            } break;
+
+            case 's': {
+                state.print_simplified = true;
+            } break;
+
+            case 'm': {
+                if (strcmp(optarg, "auto") == 0) {
+                    state.method = Minimizer_Auto;
+                } else if (strcmp(optarg, "exact") == 0) {
+                    state.method = Minimizer_Exact;
+                } else if (strcmp(optarg, "heuristic") == 0) {
+                    state.method = Minimizer_Heuristic;
+                } else {
+                    PrintUsage(argv[0]);
+                    return 2;
+                }
+            } break;
+
+            case 'c': {
+                if (strcmp(optarg, "source") == 0) {
+                    state.columns = Columns_Source;
+                } else if (strcmp(optarg, "sifted") == 0) {
+                    state.columns = Columns_Sifted;
+                } else {
+                    PrintUsage(argv[0]);
+                    return 2;
+                }
+            } break;
+
+            case 'e': {
+                AddExpression(&state, optarg);
+            } break;
+
+            case 'T': {
+                state.trace_path = optarg;
+            } break;
+
+            default: {
+                PrintUsage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+            }
+        }
+    }
+
+    if (!state.print_table && !state.print_count && !state.print_simplified)
+        state.print_table = state.print_simplified = true;
+
+    if (optind == argc && state.sources.size == 0)
+        ReadExpressions(&state, stdin);
+
+    for (int i = optind; i < argc; ++i) {
+        if (strcmp(argv[i], "-") == 0) {
+            ReadExpressions(&state, stdin);
+            continue;
+        }
+
+        FILE *file = fopen(argv[i], "r");
+        if (!file) {
+            fprintf(stderr, "error: could not open '%s'\n", argv[i]);
+            state.had_error = true;
+            continue;
+        }
+
+        ReadExpressions(&state, file);
+        fclose(file);
+    }
+
+    trace_log trace = { 0 };
+    if (state.trace_path) {
+        if (!InitializeTrace(&trace, TRACE_MAX_EVENTS)) {
+            fprintf(stderr, "error: could not allocate the trace\n");
+            return 1;
+        }
+
+        Trace = &trace;
+    }
+
+    // NOTE(fcasibu): everything is read up front so the batch can compile ahead of evaluation
+    engine *e = CreateEngine(&state.arena);
+    InterpretBatch(e, &state.arena, state.sources.items, state.sources.size, state.columns,
+                   PrintExpression, &state);
+
+    ReleaseEngine(e);
+
+    if (state.trace_path) {
+        Trace = NULL;
+
+        FILE *file = fopen(state.trace_path, "w");
+        if (file) {
+            WriteTrace(&trace, file);
+            fclose(file);
+        } else {
+            fprintf(stderr, "error: could not open '%s'\n", state.trace_path);
+            state.had_error = true;
+        }
+
+        ReleaseTrace(&trace);
+    }
+
+    PrintArenaStats(stderr, "cli", &state.arena);
+    FreeArena(&state.arena);
+
+    return state.had_error ? 1 : 0;
+}
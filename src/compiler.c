@@ -1,9 +1,4 @@
-global parser Parser;
-global chunk *CompilingChunk;
-
-#define MAX_VARS 10
-
-#define PARSE_FN(name) void name(void)
+#define PARSE_FN(name) void name(parser *p)
 internal PARSE_FN(Grouping);
 internal PARSE_FN(Binary);
 internal PARSE_FN(Unary);
@@ -28,24 +23,118 @@ global_const parse_rule RULES[] = {
 // clang-format on
 
 internal void
-InitializeParser(memory_arena *arena)
+InitializeExprDag(memory_arena *arena, expr_dag *dag, usize expected_nodes)
 {
     Assert(arena);
+    Assert(dag);
 
-    Parser.arena = arena;
-    Parser.had_error = false;
+    usize bucket_count = 64;
+    while (bucket_count < expected_nodes)
+        bucket_count *= 2;
+
+    dag->buckets = PushArray(arena, bucket_count, expr_node *);
+    ZeroArray(bucket_count, dag->buckets);
+    dag->bucket_count = bucket_count;
+    dag->node_count = 0;
+    dag->epoch = 0;
 }
 
-internal inline void
-EmitByte(u8 byte)
+internal inline u32
+HashExprNode(op_code op, u8 var_idx, const expr_node *lhs, const expr_node *rhs)
+{
+    u64 h = ((u64)op << 8) | var_idx;
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ (lhs ? lhs->id + 1 : 0);
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ (rhs ? rhs->id + 1 : 0);
+    h *= 0x9E3779B97F4A7C15ULL;
+
+    return (u32)(h >> 32);
+}
+
+internal inline b32
+IsCommutative(op_code op)
+{
+    switch (op) {
+        case OP_And:
+        case OP_Or:
+        case OP_Xor:
+        case OP_Xnor:
+        case OP_Nand:
+        case OP_Nor:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// NOTE(fcasibu): operands of commutative operators are ordered by id so A AND B and B AND A end
+// up as the same node
+internal expr_node *
+MakeExprNode(memory_arena *arena, expr_dag *dag, op_code op, u8 var_idx, expr_node *lhs,
+             expr_node *rhs)
+{
+    Assert(arena);
+    Assert(dag);
+
+    if (rhs && IsCommutative(op) && rhs->id < lhs->id) {
+        expr_node *tmp = lhs;
+        lhs = rhs;
+        rhs = tmp;
+    }
+
+    u32 hash = HashExprNode(op, var_idx, lhs, rhs);
+    expr_node **bucket = &dag->buckets[hash & (dag->bucket_count - 1)];
+
+    for (expr_node *node = *bucket; node; node = node->next_in_bucket) {
+        if (node->hash == hash && node->op == op && node->var_idx == var_idx &&
+            node->lhs == lhs && node->rhs == rhs)
+            return node;
+    }
+
+    expr_node *node = PushStruct(arena, expr_node);
+    ZeroStruct(node);
+    node->op = op;
+    node->var_idx = var_idx;
+    node->id = dag->node_count++;
+    node->hash = hash;
+    node->lhs = lhs;
+    node->rhs = rhs;
+    node->next_in_bucket = *bucket;
+    *bucket = node;
+
+    return node;
+}
+
+internal void
+InitializeParser(parser *p, memory_arena *arena, usize source_length)
 {
-    WriteChunk(Parser.arena, CompilingChunk, byte);
+    Assert(p);
+    Assert(arena);
+
+    p->arena = arena;
+    p->had_error = false;
+    p->root = NULL;
+
+    InitializeExprDag(arena, &p->dag, source_length);
+    ArrayInit(arena, &p->nodes, 64);
 }
 
 internal inline void
-EmitVar(const char *name, usize idx)
+PushExpr(parser *p, op_code op, u8 var_idx, expr_node *lhs, expr_node *rhs)
 {
-    WriteVar(Parser.arena, CompilingChunk, name, idx);
+    expr_node *node = MakeExprNode(p->arena, &p->dag, op, var_idx, lhs, rhs);
+    ArrayPush(p->arena, &p->nodes, node);
+}
+
+internal inline expr_node *
+PopExpr(parser *p)
+{
+    if (p->nodes.size == 0) {
+        p->had_error = true;
+        return NULL;
+    }
+
+    return p->nodes.items[--p->nodes.size];
 }
 
 internal inline const parse_rule *
@@ -55,70 +144,80 @@ GetRule(token_kind kind)
 }
 
 internal void
-AdvanceParser(void)
+AdvanceParser(parser *p)
 {
-    Parser.previous = Parser.current;
+    p->previous = p->current;
 
     for (;;) {
-        Parser.current = ScanToken();
+        p->current = ScanToken(&p->lexer);
 
-        if (Parser.current.kind != TokenKind_Error)
+        if (p->current.kind != TokenKind_Error)
             break;
 
         // TODO(fcasibu): Reporting
-        Parser.had_error = true;
+        p->had_error = true;
     }
 }
 
 internal inline void
-ConsumeParser(token_kind kind)
+ConsumeParser(parser *p, token_kind kind)
 {
-    if (Parser.current.kind == kind) {
-        AdvanceParser();
+    if (p->current.kind == kind) {
+        AdvanceParser(p);
         return;
     }
 
     // TODO(fcasibu): Reporting
-    Parser.had_error = true;
+    p->had_error = true;
 }
 
 internal void
-ParsePrecedence(token_precedence precedence)
+ParsePrecedence(parser *p, token_precedence precedence)
 {
-    AdvanceParser();
-    parse_fn PrefixRule = GetRule(Parser.previous.kind)->prefix;
+    AdvanceParser(p);
+    parse_fn PrefixRule = GetRule(p->previous.kind)->prefix;
 
     if (!PrefixRule) {
         // TODO(fcasibu): Reporting
-        Parser.had_error = true;
+        p->had_error = true;
         return;
     }
 
-    PrefixRule();
+    PrefixRule(p);
+
+    while (precedence <= GetRule(p->current.kind)->precedence) {
+        AdvanceParser(p);
 
-    while (precedence <= GetRule(Parser.current.kind)->precedence) {
-        AdvanceParser();
+        // NOTE(fcasibu): NOT has a precedence but no infix rule, "A NOT B" ends up here
+        parse_fn InfixRule = GetRule(p->previous.kind)->infix;
+        if (!InfixRule) {
+            // TODO(fcasibu): Reporting
+            p->had_error = true;
+            return;
+        }
 
-        parse_fn InfixRule = GetRule(Parser.previous.kind)->infix;
-        Assert(InfixRule);
-        InfixRule();
+        InfixRule(p);
     }
 }
 
 internal inline void
-Expression(void)
+Expression(parser *p)
 {
-    ParsePrecedence(Prec_Imply);
+    ParsePrecedence(p, Prec_Imply);
 }
 
 internal inline PARSE_FN(Unary)
 {
-    token tok = Parser.previous;
-    ParsePrecedence(GetRule(tok.kind)->precedence + 1);
+    token tok = p->previous;
+    ParsePrecedence(p, GetRule(tok.kind)->precedence + 1);
+
+    expr_node *operand = PopExpr(p);
+    if (!operand)
+        return;
 
     switch (tok.kind) {
         case TokenKind_Not: {
-            EmitByte(OP_Not);
+            PushExpr(p, OP_Not, 0, operand, NULL);
         } break;
 
             INVALID_DEFAULT_CASE;
@@ -127,82 +226,362 @@ internal inline PARSE_FN(Unary)
 
 internal inline PARSE_FN(Binary)
 {
-    token_kind kind = Parser.previous.kind;
-    ParsePrecedence(GetRule(kind)->precedence + 1);
+    token_kind kind = p->previous.kind;
+    ParsePrecedence(p, GetRule(kind)->precedence + 1);
+
+    expr_node *rhs = PopExpr(p);
+    expr_node *lhs = PopExpr(p);
+    if (!lhs || !rhs)
+        return;
+
+    op_code op = OP_And;
 
     switch (kind) {
         case TokenKind_And: {
-            EmitByte(OP_And);
+            op = OP_And;
         } break;
 
         case TokenKind_Nand: {
-            EmitByte(OP_Nand);
+            op = OP_Nand;
         } break;
 
         case TokenKind_Xnor: {
-            EmitByte(OP_Xnor);
+            op = OP_Xnor;
         } break;
 
         case TokenKind_Xor: {
-            EmitByte(OP_Xor);
+            op = OP_Xor;
         } break;
 
         case TokenKind_Or: {
-            EmitByte(OP_Or);
+            op = OP_Or;
         } break;
 
         case TokenKind_Nor: {
-            EmitByte(OP_Nor);
+            op = OP_Nor;
         } break;
 
         case TokenKind_Imply: {
-            EmitByte(OP_Imply);
+            op = OP_Imply;
         } break;
 
             INVALID_DEFAULT_CASE;
     }
+
+    PushExpr(p, op, 0, lhs, rhs);
 }
 
+// NOTE(fcasibu): variables get their index at parse time so the columns stay in source order
 internal inline PARSE_FN(Var)
 {
-    token tok = Parser.previous;
-
-    char buf[tok.length + 1];
-    strncpy(buf, tok.lexeme_start, tok.length);
-    buf[tok.length] = '\0';
+    token tok = p->previous;
 
-    const char *interned_string = InternString(buf);
+    const char *interned_string = InternStringN(p->strings, tok.lexeme_start, tok.length);
     Assert(interned_string);
-    i64 idx = GetInternedStringIdx(interned_string);
+    i64 idx = GetInternedStringIdx(p->strings, interned_string);
     Assert(idx >= 0);
 
     if (idx + 1 > MAX_VARS) {
-        Parser.had_error = true;
+        p->had_error = true;
         return;
     }
 
-    EmitVar(interned_string, idx);
+    usize var_idx = AddVar(p->arena, p->chunk, interned_string, idx);
+    PushExpr(p, OP_Var, (u8)var_idx, NULL, NULL);
 }
 
 internal inline PARSE_FN(Grouping)
 {
-    Expression();
-    ConsumeParser(TokenKind_RightParen);
+    Expression(p);
+    ConsumeParser(p, TokenKind_RightParen);
+}
+
+// NOTE(fcasibu): counts parents among the nodes reachable from the root only, nodes that a
+// rewrite left behind must not get a slot
+internal void
+CountExprRefs(expr_dag *dag, expr_node *node)
+{
+    expr_node *children[] = { node->lhs, node->rhs };
+
+    for (usize i = 0; i < ArrayCount(children); ++i) {
+        expr_node *child = children[i];
+        if (!child)
+            continue;
+
+        if (child->epoch != dag->epoch) {
+            child->epoch = dag->epoch;
+            child->ref_count = 1;
+            child->has_slot = false;
+            CountExprRefs(dag, child);
+        } else {
+            child->ref_count += 1;
+        }
+    }
+}
+
+// NOTE(fcasibu): shared nodes are computed once, stored into a slot and loaded from then on
+internal void
+EmitExpr(memory_arena *arena, chunk *c, expr_node *node)
+{
+    if (node->has_slot) {
+        WriteChunk(arena, c, OP_Load);
+        WriteChunk(arena, c, node->slot);
+        return;
+    }
+
+    switch (node->op) {
+        case OP_Var: {
+            WriteVar(arena, c, node->var_idx);
+        } return;
+
+        case OP_False:
+        case OP_True: {
+            WriteChunk(arena, c, node->op);
+        } return;
+
+        case OP_Not: {
+            EmitExpr(arena, c, node->lhs);
+            WriteChunk(arena, c, OP_Not);
+        } break;
+
+        default: {
+            // NOTE(fcasibu): a variable operand folds into the operator, commutative operators
+            // can take it from either side
+            expr_node *lhs = node->lhs;
+            expr_node *rhs = node->rhs;
+            if (lhs->op == OP_Var && rhs->op != OP_Var && IsCommutative(node->op)) {
+                lhs = node->rhs;
+                rhs = node->lhs;
+            }
+
+            EmitExpr(arena, c, lhs);
+            if (rhs->op == OP_Var) {
+                Assert(rhs->var_idx < c->vars.size);
+                WriteChunk(arena, c, GetVarOperandOp(node->op));
+                WriteChunk(arena, c, rhs->var_idx);
+            } else {
+                EmitExpr(arena, c, rhs);
+                WriteChunk(arena, c, node->op);
+            }
+        } break;
+    }
+
+    if (node->ref_count > 1 && c->slot_count < MAX_SLOTS) {
+        node->slot = (u8)c->slot_count++;
+        node->has_slot = true;
+
+        WriteChunk(arena, c, OP_Store);
+        WriteChunk(arena, c, node->slot);
+    }
+}
+
+internal void
+EmitDag(memory_arena *arena, chunk *c, expr_dag *dag, expr_node *root)
+{
+    Assert(arena);
+    Assert(c);
+    Assert(dag);
+    Assert(root);
+
+    dag->epoch += 1;
+    root->epoch = dag->epoch;
+    root->ref_count = 0;
+    root->has_slot = false;
+    CountExprRefs(dag, root);
+
+    EmitExpr(arena, c, root);
+    c->max_depth = GetMaxStackDepth(c);
+}
+
+typedef struct {
+    u8 regs[MAX_SLOTS];
+    u32 last_load[MAX_SLOTS];
+    u64 free_regs;
+    u64 done;
+    u8 operand_refs[MAX_REGISTERS];
+} slot_allocator;
+
+internal inline void
+ReleaseSlotOperand(slot_allocator *sa, usize slot_base, usize temp_base, u8 reg)
+{
+    if (reg < slot_base || reg >= temp_base)
+        return;
+
+    usize idx = reg - slot_base;
+    if (--sa->operand_refs[idx] == 0 && ((sa->done >> idx) & 1)) {
+        sa->done &= ~((u64)1 << idx);
+        sa->free_regs |= (u64)1 << idx;
+    }
+}
+
+// NOTE(fcasibu): replays the stack code with registers instead of stack slots. Registers are
+// [variables | slots | stack temporaries], stack slot i lives in temporary i and a slot
+// register is handed back once its last load has been consumed. Variables are read straight
+// from their registers, so only the operators become instructions. Runs once to size the
+// register file and once more to emit.
+internal b32
+LowerPass(memory_arena *arena, chunk *c, b32 emit, usize slot_regs, usize *max_slot_regs,
+          usize *max_depth)
+{
+    register_chunk *rc = &c->registers;
+    usize slot_base = c->vars.size;
+    usize temp_base = slot_base + slot_regs;
+
+    slot_allocator sa = { 0 };
+    sa.free_regs = ~(u64)0;
+
+    u8 *ip = c->items;
+    u8 *end = c->items + c->size;
+
+    for (u8 *at = ip; at < end; at += GetInstructionSize(*at)) {
+        if (*at == OP_Load)
+            sa.last_load[at[1]] = (u32)(at - c->items);
+    }
+
+    u8 operands[MAX_REGISTERS];
+    usize depth = 0;
+    *max_depth = 0;
+    *max_slot_regs = 0;
+
+    while (ip < end) {
+        u8 *at = ip;
+        op_code op = *ip++;
+
+        if (op == OP_Var || op == OP_Load) {
+            if (depth >= ArrayCount(operands))
+                return false;
+
+            u8 operand = *ip++;
+
+            if (op == OP_Load) {
+                usize idx = sa.regs[operand];
+                if ((u32)(at - c->items) == sa.last_load[operand])
+                    sa.done |= (u64)1 << idx;
+
+                sa.operand_refs[idx] += 1;
+                operand = (u8)(slot_base + idx);
+            }
+
+            operands[depth++] = operand;
+        } else if (op == OP_Store) {
+            Assert(depth >= 1);
+            Assert(operands[depth - 1] == temp_base + depth - 1);
+
+            if (!sa.free_regs)
+                return false;
+
+            usize idx = __builtin_ctzll(sa.free_regs);
+            sa.free_regs &= ~((u64)1 << idx);
+            sa.regs[*ip++] = (u8)idx;
+            sa.operand_refs[idx] = 1;
+            *max_slot_regs = Max(*max_slot_regs, idx + 1);
+
+            u8 reg = (u8)(slot_base + idx);
+            if (emit) {
+                Assert(rc->size > 0 && rc->items[rc->size - 1].dst == operands[depth - 1]);
+                rc->items[rc->size - 1].dst = reg;
+            }
+            operands[depth - 1] = reg;
+        } else if (op == OP_False || op == OP_True) {
+            if (depth >= ArrayCount(operands))
+                return false;
+
+            instruction in = { op, (u8)(temp_base + depth), 0, 0 };
+            if (emit)
+                ArrayPush(arena, rc, in);
+            operands[depth++] = in.dst;
+        } else if (op == OP_Not) {
+            Assert(depth >= 1);
+            instruction in = { op, (u8)(temp_base + depth - 1), operands[depth - 1], 0 };
+            ReleaseSlotOperand(&sa, slot_base, temp_base, in.a);
+
+            if (emit)
+                ArrayPush(arena, rc, in);
+            operands[depth - 1] = in.dst;
+        } else if (GetBinaryOp(op)) {
+            Assert(depth >= 1);
+            instruction in = { GetBinaryOp(op), (u8)(temp_base + depth - 1), operands[depth - 1],
+                               *ip++ };
+            ReleaseSlotOperand(&sa, slot_base, temp_base, in.a);
+
+            if (emit)
+                ArrayPush(arena, rc, in);
+            operands[depth - 1] = in.dst;
+        } else {
+            Assert(depth >= 2);
+            depth -= 1;
+            instruction in = { op, (u8)(temp_base + depth - 1), operands[depth - 1], operands[depth] };
+            ReleaseSlotOperand(&sa, slot_base, temp_base, in.a);
+            ReleaseSlotOperand(&sa, slot_base, temp_base, in.b);
+
+            if (emit)
+                ArrayPush(arena, rc, in);
+            operands[depth - 1] = in.dst;
+        }
+
+        *max_depth = Max(*max_depth, depth);
+    }
+
+    Assert(depth == 1);
+    rc->result = operands[0];
+
+    return true;
+}
+
+internal b32
+LowerToRegisters(memory_arena *arena, chunk *c)
+{
+    Assert(arena);
+    Assert(c);
+
+    register_chunk *rc = &c->registers;
+    rc->lowered = false;
+
+    usize slot_regs = 0;
+    usize max_depth = 0;
+
+    if (!LowerPass(arena, c, false, MAX_REGISTERS, &slot_regs, &max_depth))
+        return false;
+
+    usize register_count = c->vars.size + slot_regs + max_depth;
+    if (register_count > MAX_REGISTERS)
+        return false;
+
+    ArrayInit(arena, rc, Max(c->size / 2, 1));
+    LowerPass(arena, c, true, slot_regs, &slot_regs, &max_depth);
+
+    rc->register_count = (u8)register_count;
+    rc->lowered = true;
+
+    return true;
 }
 
+// NOTE(fcasibu): variable names are interned into p->strings, which the caller owns
 internal b32
-Parse(memory_arena *arena, chunk *c, const char *source)
+Parse(parser *p, memory_arena *arena, chunk *c, const char *source)
 {
+    Assert(p);
+    Assert(p->strings);
     Assert(arena);
     Assert(c);
     Assert(source);
 
-    InitializeLexer(source);
-    InitializeParser(arena);
-    CompilingChunk = c;
+    InitializeLexer(&p->lexer, source);
+    InitializeParser(p, arena, strlen(source));
+    p->chunk = c;
+
+    AdvanceParser(p);
+    Expression(p);
+
+    // NOTE(fcasibu): an operand where an operator belongs stops the expression early, "A AN NOT B"
+    // must not parse as A
+    ConsumeParser(p, TokenKind_Eof);
+
+    if (p->had_error || p->nodes.size != 1)
+        return false;
 
-    AdvanceParser();
-    Expression();
+    p->root = p->nodes.items[0];
+    EmitDag(arena, c, &p->dag, p->root);
 
-    return !Parser.had_error;
+    return true;
 }
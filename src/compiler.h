@@ -12,21 +12,58 @@ typedef Enum(u8, token_precedence){
 };
 // clang-format on
 
-typedef void (*parse_fn)(void);
+// NOTE(fcasibu): nodes are hash-consed, structurally equal subexpressions are the same node
+typedef struct expr_node {
+    op_code op;
+    u8 var_idx;
+    u8 slot;
+    b32 has_slot;
+
+    u32 id;
+    u32 hash;
+    u32 ref_count;
+    u32 epoch;
+
+    struct expr_node *lhs;
+    struct expr_node *rhs;
+    struct expr_node *next_in_bucket;
+} expr_node;
 
 typedef struct {
-    parse_fn prefix;
-    parse_fn infix;
-    token_precedence precedence;
-} parse_rule;
+    expr_node **buckets;
+    usize bucket_count;
+    u32 node_count;
+    u32 epoch;
+} expr_dag;
+
+typedef struct {
+    expr_node **items;
+    usize size;
+    usize capacity;
+} expr_stack;
 
 typedef struct {
     memory_arena *arena;
+    lexer lexer;
+    string_intern_array *strings;
+    chunk *chunk;
 
     token previous;
     token current;
 
+    expr_dag dag;
+    expr_stack nodes;
+    expr_node *root;
+
     b32 had_error;
 } parser;
 
+typedef void (*parse_fn)(parser *p);
+
+typedef struct {
+    parse_fn prefix;
+    parse_fn infix;
+    token_precedence precedence;
+} parse_rule;
+
 #endif // COMPILER_H
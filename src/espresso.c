@@ -0,0 +1,522 @@
+// NOTE(fcasibu): heuristic two-level minimizer after Espresso-II. The ON and OFF sets come
+// straight from the BDD or the truth table as disjoint covers, then expand/irredundant/reduce run until the
+// cover stops shrinking.
+// https://en.wikipedia.org/wiki/Espresso_heuristic_logic_minimizer
+
+#define CUBE_LOW_BITS 0x5555555555555555ULL
+
+internal inline cube
+GetUniverseCube(void)
+{
+    cube result;
+    memset(result.words, 0xFF, sizeof(result.words));
+
+    return result;
+}
+
+internal inline u32
+GetCubeVar(const cube *c, usize var_idx)
+{
+    usize shift = (var_idx % CUBE_VARS_PER_WORD) * 2;
+    return (u32)((c->words[var_idx / CUBE_VARS_PER_WORD] >> shift) & 3);
+}
+
+internal inline void
+SetCubeVar(cube *c, usize var_idx, u32 field)
+{
+    usize shift = (var_idx % CUBE_VARS_PER_WORD) * 2;
+    u64 *word = &c->words[var_idx / CUBE_VARS_PER_WORD];
+
+    *word = (*word & ~((u64)3 << shift)) | ((u64)field << shift);
+}
+
+internal inline b32
+IsUniverseCube(const cube *c)
+{
+    for (usize i = 0; i < CUBE_WORDS; ++i) {
+        if (~c->words[i])
+            return false;
+    }
+
+    return true;
+}
+
+internal inline b32
+CubesIntersect(const cube *a, const cube *b)
+{
+    for (usize i = 0; i < CUBE_WORDS; ++i) {
+        u64 both = a->words[i] & b->words[i];
+        if (((both | (both >> 1)) & CUBE_LOW_BITS) != CUBE_LOW_BITS)
+            return false;
+    }
+
+    return true;
+}
+
+// NOTE(fcasibu): a contains b
+internal inline b32
+CubeContains(const cube *a, const cube *b)
+{
+    for (usize i = 0; i < CUBE_WORDS; ++i) {
+        if ((a->words[i] & b->words[i]) != b->words[i])
+            return false;
+    }
+
+    return true;
+}
+
+internal inline usize
+CountCubeLiterals(const cube *c)
+{
+    usize result = 0;
+    for (usize i = 0; i < CUBE_WORDS; ++i) {
+        u64 dont_care = c->words[i] & (c->words[i] >> 1) & CUBE_LOW_BITS;
+        result += __builtin_popcountll(~dont_care & CUBE_LOW_BITS);
+    }
+
+    return result;
+}
+
+internal inline void
+PushCube(cover *f, cube c)
+{
+    Assert(f->size < f->capacity);
+    f->items[f->size++] = c;
+}
+
+internal b32
+CoverIntersects(const cover *f, const cube *c)
+{
+    for (usize i = 0; i < f->size; ++i) {
+        if (CubesIntersect(&f->items[i], c))
+            return true;
+    }
+
+    return false;
+}
+
+// NOTE(fcasibu): the cofactor of d by c is d with every variable c fixes widened to don't care,
+// cubes that miss c drop out. Pushed onto the scratch stack, skip marks cubes to leave out.
+internal usize
+PushCofactor(cover *scratch, const cube *cubes, usize count, const cube *c, const b32 *skip)
+{
+    usize start = scratch->size;
+
+    for (usize i = 0; i < count; ++i) {
+        if ((skip && skip[i]) || !CubesIntersect(&cubes[i], c))
+            continue;
+
+        cube d;
+        for (usize w = 0; w < CUBE_WORDS; ++w)
+            d.words[w] = cubes[i].words[w] | ~c->words[w];
+
+        PushCube(scratch, d);
+    }
+
+    return start;
+}
+
+// NOTE(fcasibu): returns the variable to split on, the most binate one or failing that the most
+// used one. var_count when no cube has a literal.
+internal usize
+SelectSplitVar(const cube *cubes, usize count, usize var_count, b32 *binate)
+{
+    u32 zeros[MAX_VARS] = { 0 };
+    u32 ones[MAX_VARS] = { 0 };
+
+    for (usize i = 0; i < count; ++i) {
+        for (usize k = 0; k < var_count; ++k) {
+            u32 field = GetCubeVar(&cubes[i], k);
+            zeros[k] += field == 1;
+            ones[k] += field == 2;
+        }
+    }
+
+    usize best = var_count;
+    *binate = false;
+
+    for (usize k = 0; k < var_count; ++k) {
+        b32 k_binate = zeros[k] && ones[k];
+        u32 score = zeros[k] + ones[k];
+        if (!score || (*binate && !k_binate))
+            continue;
+
+        if (best == var_count || (k_binate && !*binate) || score > zeros[best] + ones[best]) {
+            best = k;
+            *binate = k_binate;
+        }
+    }
+
+    return best;
+}
+
+internal b32
+IsTautology(cover *scratch, const cube *cubes, usize count, usize var_count)
+{
+    if (count == 0)
+        return false;
+
+    for (usize i = 0; i < count; ++i) {
+        if (IsUniverseCube(&cubes[i]))
+            return true;
+    }
+
+    // NOTE(fcasibu): a unate cover is a tautology only if it holds the universe cube
+    b32 binate;
+    usize var_idx = SelectSplitVar(cubes, count, var_count, &binate);
+    if (!binate)
+        return false;
+
+    for (u32 field = 1; field <= 2; ++field) {
+        cube literal = GetUniverseCube();
+        SetCubeVar(&literal, var_idx, field);
+
+        usize start = PushCofactor(scratch, cubes, count, &literal, NULL);
+        b32 tautology =
+            IsTautology(scratch, scratch->items + start, scratch->size - start, var_count);
+        scratch->size = start;
+
+        if (!tautology)
+            return false;
+    }
+
+    return true;
+}
+
+// NOTE(fcasibu): smallest cube holding the complement of the cover, false when the complement
+// is empty
+internal b32
+SupercubeOfComplement(cover *scratch, const cube *cubes, usize count, usize var_count, cube *out)
+{
+    if (count == 0) {
+        *out = GetUniverseCube();
+        return true;
+    }
+
+    for (usize i = 0; i < count; ++i) {
+        if (IsUniverseCube(&cubes[i]))
+            return false;
+    }
+
+    // NOTE(fcasibu): the complement of a single cube is one flipped literal per variable it
+    // fixes, two or more of those already span everything
+    if (count == 1) {
+        *out = GetUniverseCube();
+        if (CountCubeLiterals(&cubes[0]) == 1) {
+            for (usize k = 0; k < var_count; ++k) {
+                u32 field = GetCubeVar(&cubes[0], k);
+                if (field != 3)
+                    SetCubeVar(out, k, ~field & 3);
+            }
+        }
+
+        return true;
+    }
+
+    b32 binate;
+    usize var_idx = SelectSplitVar(cubes, count, var_count, &binate);
+    Assert(var_idx < var_count);
+
+    b32 found = false;
+    for (u32 field = 1; field <= 2; ++field) {
+        cube literal = GetUniverseCube();
+        SetCubeVar(&literal, var_idx, field);
+
+        cube part;
+        usize start = PushCofactor(scratch, cubes, count, &literal, NULL);
+        b32 nonempty = SupercubeOfComplement(scratch, scratch->items + start,
+                                             scratch->size - start, var_count, &part);
+        scratch->size = start;
+
+        if (!nonempty)
+            continue;
+
+        SetCubeVar(&part, var_idx, field);
+        if (found) {
+            for (usize w = 0; w < CUBE_WORDS; ++w)
+                out->words[w] |= part.words[w];
+        } else {
+            *out = part;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+// NOTE(fcasibu): 0 all zeros, 1 all ones, 2 mixed, for rows [base, base + 2^k)
+internal u32
+GetRowRangeValue(const truth_table *table, u64 base, usize k)
+{
+    Assert(table->results.size > 0);
+    const u64 *words = table->results.items;
+
+    if (k < 6) {
+        u64 mask = ((u64)1 << ((u64)1 << k)) - 1;
+        u64 bits = (words[base / 64] >> (base % 64)) & mask;
+        return bits == 0 ? 0 : bits == mask ? 1 : 2;
+    }
+
+    u64 first = base / 64;
+    u64 count = (u64)1 << (k - 6);
+    u64 expected = words[first];
+    if (expected != 0 && expected != ~(u64)0)
+        return 2;
+
+    for (u64 i = 1; i < count; ++i) {
+        if (words[first + i] != expected)
+            return 2;
+    }
+
+    return expected ? 1 : 0;
+}
+
+// NOTE(fcasibu): Shannon expansion from the top variable down, every uniform range becomes one
+// cube of whichever set it belongs to
+internal void
+BuildTableCovers(memory_arena *arena, const truth_table *table, usize var_count, u64 base,
+                 usize k, cover *on, cover *off)
+{
+    u32 value = GetRowRangeValue(table, base, k);
+
+    if (value == 2) {
+        Assert(k > 0);
+        BuildTableCovers(arena, table, var_count, base, k - 1, on, off);
+        BuildTableCovers(arena, table, var_count, base + ((u64)1 << (k - 1)), k - 1, on, off);
+        return;
+    }
+
+    cube c = GetUniverseCube();
+    for (usize i = k; i < var_count; ++i)
+        SetCubeVar(&c, i, ((base >> i) & 1) ? 2 : 1);
+
+    ArrayPush(arena, value ? on : off, c);
+}
+
+internal void
+CollectBddCubes(memory_arena *arena, const bdd_manager *m, bdd_ref f, cube path, cover *on,
+                cover *off)
+{
+    if (IsBddTerminal(f)) {
+        ArrayPush(arena, f == BDD_TRUE ? on : off, path);
+        return;
+    }
+
+    const bdd_node *node = &m->nodes.items[f];
+
+    SetCubeVar(&path, node->var, 1);
+    CollectBddCubes(arena, m, node->lo, path, on, off);
+
+    SetCubeVar(&path, node->var, 2);
+    CollectBddCubes(arena, m, node->hi, path, on, off);
+}
+
+// NOTE(fcasibu): greedy order, cubes with the fewest literals first
+internal void
+SortCoverBySize(memory_arena *arena, cover *f)
+{
+    usize counts[MAX_VARS + 2] = { 0 };
+    for (usize i = 0; i < f->size; ++i)
+        counts[CountCubeLiterals(&f->items[i]) + 1] += 1;
+
+    for (usize i = 1; i < ArrayCount(counts); ++i)
+        counts[i] += counts[i - 1];
+
+    cube *sorted = PushArray(arena, f->capacity, cube);
+    for (usize i = 0; i < f->size; ++i)
+        sorted[counts[CountCubeLiterals(&f->items[i])]++] = f->items[i];
+
+    f->items = sorted;
+}
+
+internal void
+CompactCover(cover *f, const b32 *removed)
+{
+    usize size = 0;
+    for (usize i = 0; i < f->size; ++i) {
+        if (!removed[i])
+            f->items[size++] = f->items[i];
+    }
+
+    f->size = size;
+}
+
+// NOTE(fcasibu): raises literals one at a time while the cube stays clear of the OFF set, then
+// drops every cube the expanded one now contains
+internal void
+ExpandCover(memory_arena *arena, cover *f, const cover *off, usize var_count)
+{
+    SortCoverBySize(arena, f);
+
+    b32 *covered = PushArray(arena, f->size, b32);
+    ZeroArray(f->size, covered);
+
+    for (usize i = 0; i < f->size; ++i) {
+        if (covered[i])
+            continue;
+
+        cube c = f->items[i];
+        for (usize k = 0; k < var_count; ++k) {
+            if (GetCubeVar(&c, k) == 3)
+                continue;
+
+            cube trial = c;
+            SetCubeVar(&trial, k, 3);
+            if (!CoverIntersects(off, &trial))
+                c = trial;
+        }
+
+        f->items[i] = c;
+        for (usize j = 0; j < f->size; ++j) {
+            if (j != i && !covered[j] && CubeContains(&c, &f->items[j]))
+                covered[j] = true;
+        }
+    }
+
+    CompactCover(f, covered);
+}
+
+// NOTE(fcasibu): a cube is redundant when the rest of the cover, cofactored by it, is a
+// tautology. Smallest cubes are tried first since they are the likeliest to go.
+internal void
+IrredundantCover(memory_arena *arena, cover *f, cover *scratch, usize var_count)
+{
+    b32 *removed = PushArray(arena, f->size, b32);
+    ZeroArray(f->size, removed);
+
+    for (usize i = f->size; i > 0; --i) {
+        usize idx = i - 1;
+        removed[idx] = true;
+
+        usize start = PushCofactor(scratch, f->items, f->size, &f->items[idx], removed);
+        b32 redundant =
+            IsTautology(scratch, scratch->items + start, scratch->size - start, var_count);
+        scratch->size = start;
+
+        removed[idx] = redundant;
+    }
+
+    CompactCover(f, removed);
+}
+
+// NOTE(fcasibu): shrinks every cube to the smallest one holding the minterms only it covers,
+// which gives the next expand room to find different primes
+internal void
+ReduceCover(memory_arena *arena, cover *f, cover *scratch, usize var_count)
+{
+    SortCoverBySize(arena, f);
+
+    b32 *removed = PushArray(arena, f->size, b32);
+    ZeroArray(f->size, removed);
+
+    for (usize i = 0; i < f->size; ++i) {
+        removed[i] = true;
+
+        cube c = f->items[i];
+        cube keep;
+        usize start = PushCofactor(scratch, f->items, f->size, &c, removed);
+        b32 nonempty = SupercubeOfComplement(scratch, scratch->items + start,
+                                             scratch->size - start, var_count, &keep);
+        scratch->size = start;
+
+        if (!nonempty)
+            continue;
+
+        for (usize w = 0; w < CUBE_WORDS; ++w)
+            f->items[i].words[w] = c.words[w] & keep.words[w];
+        removed[i] = false;
+    }
+
+    CompactCover(f, removed);
+}
+
+internal usize
+GetCoverLiteralCount(const cover *f)
+{
+    usize result = 0;
+    for (usize i = 0; i < f->size; ++i)
+        result += CountCubeLiterals(&f->items[i]);
+
+    return result;
+}
+
+internal cover
+CopyCover(memory_arena *arena, const cover *f)
+{
+    cover result = *f;
+    result.items = PushArray(arena, f->capacity, cube);
+    memcpy(result.items, f->items, f->size * sizeof(cube));
+
+    return result;
+}
+
+internal implicants *
+MinimizeHeuristic(memory_arena *arena, const truth_table *table)
+{
+    Assert(table);
+
+    usize var_count = table->vars.size;
+    Assert(var_count > 0 && var_count <= MAX_VARS);
+
+    cover on = { 0 };
+    cover off = { 0 };
+    ArrayInit(arena, &on, 64);
+    ArrayInit(arena, &off, 64);
+
+    bdd_manager *bdd = table->bdd;
+    bdd_ref root = table->root;
+    if (!bdd && table->chunk) {
+        TraceBlock("BuildSiftedBdd", "vars", var_count, NULL, 0) {
+            bdd = BuildSiftedBdd(arena, table->chunk, &root);
+        }
+
+        if (bdd->overflowed)
+            bdd = NULL;
+    }
+
+    // NOTE(fcasibu): paths to 1 and to 0 are already disjoint ON and OFF covers, usually far
+    // fewer than the uniform ranges of the table
+    if (bdd)
+        CollectBddCubes(arena, bdd, root, GetUniverseCube(), &on, &off);
+    else
+        BuildTableCovers(arena, table, var_count, 0, var_count, &on, &off);
+
+    cover scratch = { 0 };
+    ArrayInit(arena, &scratch, (var_count + 2) * (on.size + 1));
+
+    ExpandCover(arena, &on, &off, var_count);
+    IrredundantCover(arena, &on, &scratch, var_count);
+
+    for (;;) {
+        cover next = CopyCover(arena, &on);
+        ReduceCover(arena, &next, &scratch, var_count);
+        ExpandCover(arena, &next, &off, var_count);
+        IrredundantCover(arena, &next, &scratch, var_count);
+
+        b32 fewer_cubes = next.size < on.size;
+        b32 fewer_literals =
+            next.size == on.size && GetCoverLiteralCount(&next) < GetCoverLiteralCount(&on);
+        if (!fewer_cubes && !fewer_literals)
+            break;
+
+        on = next;
+    }
+
+    implicants *result = PushStruct(arena, implicants);
+    ArrayInit(arena, result, Max(on.size, 1));
+
+    for (usize i = 0; i < on.size; ++i) {
+        implicant imp = { 0 };
+        for (usize k = 0; k < var_count; ++k) {
+            u32 field = GetCubeVar(&on.items[i], k);
+            if (field == 3)
+                imp.mask |= (u32)1 << k;
+            else if (field == 2)
+                imp.value |= (u32)1 << k;
+        }
+
+        ArrayPush(arena, result, imp);
+    }
+
+    return result;
+}
@@ -0,0 +1,19 @@
+#ifndef ESPRESSO_H
+#define ESPRESSO_H
+
+// NOTE(fcasibu): positional cube notation, variable i owns bits 2i (may be 0) and 2i + 1 (may be
+// 1) so 11 is a don't care and 00 empties the cube. Variables past the table are kept at 11.
+#define CUBE_VARS_PER_WORD 32
+#define CUBE_WORDS ((MAX_VARS + CUBE_VARS_PER_WORD - 1) / CUBE_VARS_PER_WORD)
+
+typedef struct {
+    u64 words[CUBE_WORDS];
+} cube;
+
+typedef struct {
+    cube *items;
+    usize size;
+    usize capacity;
+} cover;
+
+#endif // ESPRESSO_H
@@ -8,20 +8,35 @@
 #include "base.h"
 #include "arena.h"
 #include "platform.h"
+#include "trace.h"
+#include "profiler.h"
 
 #include "intern.h"
 #include "lexer.h"
+#include "jit.h"
 #include "chunk.h"
 #include "compiler.h"
+#include "bdd.h"
+#include "scheduler.h"
 #include "vm.h"
+#include "espresso.h"
+#include "incremental.h"
 #include "game.h"
 
+#include "trace.c"
 #include "arena.c"
+#include "profiler.c"
 #include "intern.c"
 #include "lexer.c"
 #include "chunk.c"
 #include "compiler.c"
+#include "optimizer.c"
+#include "scheduler.c"
+#include "jit.c"
+#include "bdd.c"
+#include "espresso.c"
 #include "vm.c"
+#include "incremental.c"
 
 #define TOOLBAR_H 60.0f
 #define ROW_H 30.0f
@@ -29,47 +44,110 @@
 internal void
 RunEvaluation(context *ctx, game_state *state)
 {
-    ArenaReset(&state->result_arena);
+    ArenaRecycle(&state->result_arena);
 
     state->input_count = strlen(state->input_buf);
-    state->result = Interpret(&state->result_arena, state->input_buf);
+    memset(state->live_buf, 0, INPUT_BUF_SIZE);
+    strncpy(state->live_buf, state->input_buf, INPUT_BUF_SIZE - 1);
+
+    state->result = Interpret(state->engine, &state->result_arena, state->input_buf, state->columns);
+    RecordProfileArena(state->engine->profiler, &state->result_arena);
 
     if (state->result.type == Eval_Ok) {
+        state->true_rows = GetTrueRowCount(state->result.value.table);
         state->selected_row = 0;
-        state->scroll_y = 0;
+        state->scroll_row = 0;
+        state->scroll_offset = 0;
         ctx->has_error = false;
     } else {
         ctx->has_error = true;
     }
 }
 
+// NOTE(fcasibu): a parse error while typing keeps the last table on screen, only the source
+// column order is incremental so sifted falls back to a full evaluation
+internal void
+RunLiveEvaluation(context *ctx, game_state *state)
+{
+    if (state->columns != Columns_Source) {
+        RunEvaluation(ctx, state);
+        return;
+    }
+
+    memset(state->live_buf, 0, INPUT_BUF_SIZE);
+    strncpy(state->live_buf, state->input_buf, INPUT_BUF_SIZE - 1);
+
+    eval_result result = EvaluateIncremental(state->engine, &state->incremental, state->input_buf);
+    ctx->has_error = result.type != Eval_Ok;
+
+    if (result.type == Eval_Ok) {
+        state->result = result;
+        state->true_rows = GetTrueRowCount(result.value.table);
+        if (state->selected_row >= result.value.table->row_count)
+            state->selected_row = 0;
+
+        RecordProfileArena(state->engine->profiler,
+                           &state->incremental.arenas[state->incremental.current]);
+    }
+}
+
+// NOTE(fcasibu): moves by delta pixels, at most until the last row sits at the bottom of the view
+internal void
+ScrollTruthTable(game_state *state, const truth_table *table, f32 view_h, f32 delta)
+{
+    f32 offset = state->scroll_offset + delta;
+    i64 rows = (i64)(offset / ROW_H);
+    if (rows * ROW_H > offset)
+        --rows;
+
+    state->scroll_offset = offset - rows * ROW_H;
+    if (rows < 0 && (u64)-rows > state->scroll_row) {
+        state->scroll_row = 0;
+        state->scroll_offset = 0;
+    } else {
+        state->scroll_row += rows;
+    }
+
+    u64 view_rows = (u64)(view_h / ROW_H);
+    if (view_rows * ROW_H < view_h)
+        ++view_rows;
+
+    u64 max_row = 0;
+    f32 max_offset = 0;
+    if (table->row_count >= view_rows) {
+        max_row = table->row_count - view_rows;
+        max_offset = view_rows * ROW_H - view_h;
+    }
+
+    if (state->scroll_row > max_row ||
+        (state->scroll_row == max_row && state->scroll_offset > max_offset)) {
+        state->scroll_row = max_row;
+        state->scroll_offset = max_offset;
+    }
+}
+
 internal void
 DrawTruthTableUI(context *ctx, game_state *state, Vector2 m)
 {
     truth_table *table = state->result.value.table;
+    f32 view_h = ctx->height - TOOLBAR_H - 40;
 
-    if (!state->input_active) {
-        state->scroll_y -= GetMouseWheelMove() * (ROW_H * 3);
-        if (state->scroll_y < 0)
-            state->scroll_y = 0;
+    f32 wheel = state->input_active ? 0 : GetMouseWheelMove();
+    ScrollTruthTable(state, table, view_h, -wheel * (ROW_H * 3));
 
-        f32 max_scroll = (table->row_count * ROW_H) - (ctx->height - TOOLBAR_H - 40);
-        if (state->scroll_y > max_scroll && max_scroll > 0)
-            state->scroll_y = max_scroll;
-
-        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && m.y < ctx->height - TOOLBAR_H) {
-            usize clicked = ((m.y - 40 + state->scroll_y) / ROW_H);
-            if (clicked < table->row_count)
-                state->selected_row = clicked;
-        }
+    if (!state->input_active && IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && m.y >= 40 &&
+        m.y < ctx->height - TOOLBAR_H) {
+        u64 clicked = state->scroll_row + (u64)((m.y - 40 + state->scroll_offset) / ROW_H);
+        if (clicked < table->row_count)
+            state->selected_row = clicked;
     }
 
-    BeginScissorMode(0, 40, ctx->width, ctx->height - TOOLBAR_H - 40);
-    usize start = (state->scroll_y / ROW_H);
-    usize end = start + (ctx->height / ROW_H) + 2;
+    BeginScissorMode(0, 40, ctx->width, view_h);
+    u64 start = state->scroll_row;
+    u64 end = start + (ctx->height / ROW_H) + 2;
 
-    for (usize i = start; i < end && i < table->row_count; ++i) {
-        f32 y = 40 + (i * ROW_H - state->scroll_y);
+    for (u64 i = start; i < end && i < table->row_count; ++i) {
+        f32 y = 40 + ((i - start) * ROW_H - state->scroll_offset);
         if (i == state->selected_row)
             DrawRectangle(0, y, ctx->width, ROW_H, DARKGRAY);
 
@@ -88,6 +166,73 @@ DrawTruthTableUI(context *ctx, game_state *state, Vector2 m)
         DrawText(table->vars.items[k], 15 + (k * 35), 10, 16, WHITE);
 
     DrawText("RESULT", 25 + (table->vars.size * 35), 10, 16, GOLD);
+
+    const char *true_rows = TextFormat("%llu of %llu true", (unsigned long long)state->true_rows,
+                                       (unsigned long long)table->row_count);
+    DrawText(true_rows, ctx->width - MeasureText(true_rows, 16) - 15, 10, 16, GRAY);
+}
+
+// NOTE(fcasibu): the phases of the latest frame that evaluated anything, the frame times are over
+// the whole ring so a slow frame stays visible for a couple of seconds
+internal void
+DrawProfilerOverlay(context *ctx, game_state *state)
+{
+    profiler *p = &state->profiler;
+    const profile_frame *work = &p->last_work;
+
+    u64 frame_count = Min(p->frame_idx, PROFILER_FRAME_COUNT);
+    u64 total_cycles = 0;
+    u64 max_cycles = 0;
+    for (u64 i = 0; i < frame_count; ++i) {
+        total_cycles += p->frames[i].frame_cycles;
+        max_cycles = Max(max_cycles, p->frames[i].frame_cycles);
+    }
+
+    f32 line_h = 18;
+    f32 w = 250;
+    f32 h = (Phase_Count + 6) * line_h + 10;
+    f32 x = ctx->width - w - 20;
+    f32 y = 50;
+
+    DrawRectangle(x, y, w, h, Fade(BLACK, 0.85f));
+    DrawRectangleLines(x, y, w, h, DARKGRAY);
+
+    x += 10;
+    y += 5;
+
+    DrawText("LAST EVALUATION", x, y, 14, GOLD);
+    y += line_h;
+
+    for (usize i = 0; i < Phase_Count; ++i) {
+        DrawText(PROFILE_PHASE_NAMES[i], x, y, 14, GRAY);
+        DrawText(TextFormat("%10.1f us", GetProfileMicroseconds(p, work->cycles[i])), x + 110, y,
+                 14, WHITE);
+        y += line_h;
+    }
+
+    DrawText("rows", x, y, 14, GRAY);
+    DrawText(TextFormat("%llu", (unsigned long long)work->rows), x + 110, y, 14, WHITE);
+    y += line_h;
+
+    DrawText("arena", x, y, 14, GRAY);
+    DrawText(TextFormat("%.1f KB", (f64)work->arena_bytes / KB(1)), x + 110, y, 14, WHITE);
+    y += line_h;
+
+    DrawText("live reuse", x, y, 14, GRAY);
+    incremental_evaluator *ie = &state->incremental;
+    DrawText(TextFormat("%zu/%zu subtrees", ie->reused_count,
+                        ie->reused_count + ie->evaluated_count),
+             x + 110, y, 14, WHITE);
+    y += line_h;
+
+    DrawText("frame avg", x, y, 14, GRAY);
+    f64 avg_us = frame_count ? GetProfileMicroseconds(p, total_cycles / frame_count) : 0;
+    DrawText(TextFormat("%.2f ms", avg_us / 1000.0), x + 110, y, 14, WHITE);
+    y += line_h;
+
+    DrawText("frame max", x, y, 14, GRAY);
+    DrawText(TextFormat("%.2f ms", GetProfileMicroseconds(p, max_cycles) / 1000.0), x + 110, y,
+             14, WHITE);
 }
 
 internal void
@@ -134,6 +279,7 @@ HandleInputShortcuts(game_state *state)
 extern GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
 {
     game_state *state = (game_state *)ctx->permanent_storage;
+    Platform = ctx->platform;
 
     if (!state->is_initialized) {
         InitializeArena(&state->main_arena,
@@ -143,6 +289,13 @@ extern GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
         InitializeArena(
             &state->result_arena, ctx->temporary_storage_size, (u8 *)ctx->temporary_storage);
 
+        state->engine = CreateEngine(&state->main_arena);
+
+        InitializeProfiler(&state->profiler);
+        state->engine->profiler = &state->profiler;
+
+        InitializeIncrementalEvaluator(&state->incremental, &state->main_arena);
+
         state->input_active = false;
         state->is_initialized = true;
         state->input_count = 0;
@@ -151,15 +304,27 @@ extern GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
         GuiSetStyle(DEFAULT, BORDER_WIDTH, 2);
     }
 
+    BeginProfileFrame(&state->profiler);
+
     temporary_memory temp_mem = BeginTemporaryMemory(&state->main_arena);
     Vector2 m = GetMousePosition();
 
-    Rectangle r_input = { 20, ctx->height - 45, 950, 30 };
+    Rectangle r_input = { 20, ctx->height - 45, 656, 30 };
+    Rectangle r_live = { 691, ctx->height - 45, 137, 30 };
+    Rectangle r_order = { 838, ctx->height - 45, 137, 30 };
     Rectangle r_eval = { 985, ctx->height - 45, 137, 30 };
     Rectangle r_simp = { 985 + 147, ctx->height - 45, 137, 30 };
 
     HandleInputShortcuts(state);
 
+    if (ARENA_STATS_ENABLED && IsKeyPressed(KEY_F2)) {
+        PrintArenaStats(stderr, "main", &state->main_arena);
+        PrintArenaStats(stderr, "result", &state->result_arena);
+    }
+
+    if (IsKeyPressed(KEY_F3))
+        state->show_profiler = !state->show_profiler;
+
     BeginDrawing();
     ClearBackground(BLACK);
 
@@ -199,22 +364,47 @@ extern GAME_UPDATE_AND_RENDER(GameUpdateAndRender)
         RunEvaluation(ctx, state);
     }
 
+    if (GuiButton(r_live, state->live ? "LIVE: ON" : "LIVE: OFF")) {
+        state->live = !state->live;
+        memset(state->live_buf, 0, INPUT_BUF_SIZE);
+    }
+
+    if (state->live && state->input_buf[0] && strcmp(state->input_buf, state->live_buf) != 0)
+        RunLiveEvaluation(ctx, state);
+
+    if (GuiButton(r_order, state->columns == Columns_Sifted ? "ORDER: BDD" : "ORDER: SRC")) {
+        state->columns = state->columns == Columns_Sifted ? Columns_Source : Columns_Sifted;
+
+        if (state->result.type == Eval_Ok)
+            RunEvaluation(ctx, state);
+    }
+
     if (GuiButton(r_simp, "SIMPLIFY") && state->result.type == Eval_Ok) {
         memset(state->prev_buf, 0, INPUT_BUF_SIZE);
         strncpy(state->prev_buf, state->input_buf, INPUT_BUF_SIZE - 1);
 
-        const char *simp = SimplifyExpression(temp_mem.arena, state->result.value.table);
+        const char *simp = NULL;
+        ProfileBlock(&state->profiler, Phase_Simplify) {
+            simp = SimplifyExpression(temp_mem.arena, state->result.value.table, Minimizer_Auto);
+        }
 
-        memset(state->input_buf, 0, INPUT_BUF_SIZE);
-        usize len = strlen(simp);
-        if (len >= INPUT_BUF_SIZE)
-            len = INPUT_BUF_SIZE - 1;
+        if (simp) {
+            memset(state->input_buf, 0, INPUT_BUF_SIZE);
+            usize len = strlen(simp);
+            if (len >= INPUT_BUF_SIZE)
+                len = INPUT_BUF_SIZE - 1;
 
-        strncpy(state->input_buf, simp, len);
+            strncpy(state->input_buf, simp, len);
 
-        RunEvaluation(ctx, state);
+            RunEvaluation(ctx, state);
+        }
     }
 
+    if (state->show_profiler)
+        DrawProfilerOverlay(ctx, state);
+
     EndDrawing();
     EndTemporaryMemory(temp_mem);
+
+    EndProfileFrame(&state->profiler);
 }
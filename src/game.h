@@ -14,9 +14,26 @@ typedef struct {
     memory_arena main_arena;
     memory_arena result_arena;
 
+    engine *engine;
+    profiler profiler;
+    b32 show_profiler;
+
+    // NOTE(fcasibu): with live on every edit is evaluated incrementally, live_buf is the text the
+    // current result came from
+    incremental_evaluator incremental;
+    b32 live;
+    char live_buf[INPUT_BUF_SIZE];
+
     eval_result result;
+    column_order columns;
+
+    // NOTE(fcasibu): counted once per evaluation, on the BDD when the result has one
+    u64 true_rows;
 
-    f32 scroll_y;
+    // NOTE(fcasibu): a row plus the pixels into it, 2^32 rows are more pixels than an f32 can
+    // step through
+    u64 scroll_row;
+    f32 scroll_offset;
     usize selected_row;
 } game_state;
 
@@ -0,0 +1,370 @@
+internal void
+InitializeIncrementalEvaluator(incremental_evaluator *ie, memory_arena *arena)
+{
+    Assert(ie);
+    Assert(arena);
+
+    ZeroStruct(ie);
+
+    for (usize i = 0; i < ArrayCount(ie->arenas); ++i)
+        InitializeArena(&ie->arenas[i], INCREMENTAL_ARENA_SIZE,
+                        PushSize(arena, INCREMENTAL_ARENA_SIZE));
+}
+
+// NOTE(fcasibu): commutative operands are hashed in a fixed order, the parser only orders them by
+// node id which differs between two parses of the same text
+internal u64
+HashSubtree(u64 *hashes, const expr_node *node)
+{
+    if (hashes[node->id])
+        return hashes[node->id];
+
+    u64 h = ((((u64)node->op << 8) | node->var_idx) + 1) * 0x9E3779B97F4A7C15ULL;
+
+    if (node->lhs) {
+        u64 a = HashSubtree(hashes, node->lhs);
+        u64 b = node->rhs ? HashSubtree(hashes, node->rhs) : 0;
+
+        if (node->rhs && IsCommutative(node->op) && b < a) {
+            u64 t = a;
+            a = b;
+            b = t;
+        }
+
+        h = (h ^ a) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+        h = (h ^ b) * 0x94D049BB133111EBULL;
+        h ^= h >> 29;
+    }
+
+    // NOTE(fcasibu): 0 marks a hash that was not computed yet
+    h |= 1;
+    hashes[node->id] = h;
+
+    return h;
+}
+
+// NOTE(fcasibu): nodes of the expression tree under node with shared subtrees counted every time,
+// which is the work evaluating it as a leaf costs
+internal u32
+CountSubtreeNodes(u32 *sizes, const expr_node *node)
+{
+    if (sizes[node->id])
+        return sizes[node->id];
+
+    u64 size = 1;
+    if (node->lhs)
+        size += CountSubtreeNodes(sizes, node->lhs);
+    if (node->rhs)
+        size += CountSubtreeNodes(sizes, node->rhs);
+
+    sizes[node->id] = (u32)Min(size, UINT32_MAX);
+
+    return sizes[node->id];
+}
+
+// NOTE(fcasibu): the hashes only narrow it down, the trees are compared for real. a and b are in
+// different DAGs, each with its own hash array.
+internal b32
+SubtreesEqual(const u64 *a_hashes, const expr_node *a, const u64 *b_hashes, const expr_node *b)
+{
+    if (a_hashes[a->id] != b_hashes[b->id] || a->op != b->op || a->var_idx != b->var_idx)
+        return false;
+
+    if (!a->lhs)
+        return true;
+
+    if (!a->rhs)
+        return SubtreesEqual(a_hashes, a->lhs, b_hashes, b->lhs);
+
+    if (SubtreesEqual(a_hashes, a->lhs, b_hashes, b->lhs) &&
+        SubtreesEqual(a_hashes, a->rhs, b_hashes, b->rhs))
+        return true;
+
+    return IsCommutative(a->op) && SubtreesEqual(a_hashes, a->lhs, b_hashes, b->rhs) &&
+           SubtreesEqual(a_hashes, a->rhs, b_hashes, b->lhs);
+}
+
+internal void
+InitializeSubtreeResults(memory_arena *arena, subtree_results *r, usize expected)
+{
+    usize capacity = 16;
+    while (capacity < expected * 2)
+        capacity *= 2;
+
+    r->items = PushArray(arena, capacity, subtree_result);
+    ZeroArray(capacity, r->items);
+    r->capacity = capacity;
+}
+
+// NOTE(fcasibu): the cell holding node or the empty cell it would go in, only for nodes of the DAG
+// the results were built from
+internal subtree_result *
+GetSubtreeResult(subtree_results *r, u64 hash, const expr_node *node)
+{
+    usize mask = r->capacity - 1;
+
+    for (usize i = hash & mask;; i = (i + 1) & mask) {
+        subtree_result *result = &r->items[i];
+        if (!result->node || result->node == node)
+            return result;
+    }
+}
+
+internal subtree_result *
+FindCachedSubtree(incremental_evaluator *ie, const u64 *hashes, const expr_node *node)
+{
+    if (!ie->valid)
+        return NULL;
+
+    u64 hash = hashes[node->id];
+    usize mask = ie->results.capacity - 1;
+
+    for (usize i = hash & mask;; i = (i + 1) & mask) {
+        subtree_result *result = &ie->results.items[i];
+        if (!result->node)
+            return NULL;
+
+        if (result->hash == hash && SubtreesEqual(ie->hashes, result->node, hashes, node))
+            return result;
+    }
+}
+
+internal b32
+HasSameColumns(const references *a, const vars *b)
+{
+    if (a->size != b->size)
+        return false;
+
+    for (usize i = 0; i < a->size; ++i) {
+        if (strcmp(a->items[i], b->items[i].name) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+internal void
+CombineSubtreeWords(op_code op, const u64 *a, const u64 *b, u64 *out, usize word_count)
+{
+    switch (op) {
+        case OP_Not: {
+            for (usize i = 0; i < word_count; ++i)
+                out[i] = ~a[i];
+        } break;
+
+        case OP_And: {
+            for (usize i = 0; i < word_count; ++i)
+                out[i] = a[i] & b[i];
+        } break;
+
+        case OP_Or: {
+            for (usize i = 0; i < word_count; ++i)
+                out[i] = a[i] | b[i];
+        } break;
+
+        case OP_Xor: {
+            for (usize i = 0; i < word_count; ++i)
+                out[i] = a[i] ^ b[i];
+        } break;
+
+        case OP_Xnor: {
+            for (usize i = 0; i < word_count; ++i)
+                out[i] = ~(a[i] ^ b[i]);
+        } break;
+
+        case OP_Nand: {
+            for (usize i = 0; i < word_count; ++i)
+                out[i] = ~(a[i] & b[i]);
+        } break;
+
+        case OP_Nor: {
+            for (usize i = 0; i < word_count; ++i)
+                out[i] = ~(a[i] | b[i]);
+        } break;
+
+        case OP_Imply: {
+            for (usize i = 0; i < word_count; ++i)
+                out[i] = ~a[i] | b[i];
+        } break;
+
+            INVALID_DEFAULT_CASE;
+    }
+}
+
+typedef struct {
+    engine *engine;
+    memory_arena *arena;
+    incremental_evaluator *ie;
+
+    expr_dag *dag;
+    const vars *vars;
+    u64 *hashes;
+    u32 *sizes;
+    subtree_results results;
+
+    usize word_count;
+    usize leaf_nodes;
+} incremental_pass;
+
+// NOTE(fcasibu): the subtree as its own chunk over every column of the expression, so its words
+// line up with the rest of the table
+internal u64 *
+EvaluateLeafSubtree(incremental_pass *pass, expr_node *node)
+{
+    engine *e = pass->engine;
+    memory_arena *arena = pass->arena;
+
+    chunk *c = PushStruct(arena, chunk);
+    ZeroStruct(c);
+    InitializeChunk(arena, c, 256);
+    c->vars = *pass->vars;
+
+    EmitDag(arena, c, pass->dag, node);
+    OptimizeChunk(arena, c);
+    LowerToRegisters(arena, c);
+
+    c->native = CompileNative(&e->jit, c);
+    InitializeVM(&e->vm, arena, c);
+
+    return GetTruthTable(&e->vm, arena)->results.items;
+}
+
+internal u64 *
+EvaluateSubtree(incremental_pass *pass, expr_node *node)
+{
+    u64 hash = pass->hashes[node->id];
+
+    subtree_result *result = GetSubtreeResult(&pass->results, hash, node);
+    if (result->node)
+        return result->words;
+
+    u64 *words = NULL;
+    subtree_result *cached = FindCachedSubtree(pass->ie, pass->hashes, node);
+
+    if (cached) {
+        // NOTE(fcasibu): copied since the arena the cached words live in is recycled next round
+        words = PushArray(pass->arena, pass->word_count, u64);
+        memcpy(words, cached->words, pass->word_count * sizeof(u64));
+        pass->ie->reused_count += 1;
+    } else if (!node->lhs || pass->sizes[node->id] <= pass->leaf_nodes) {
+        words = EvaluateLeafSubtree(pass, node);
+        pass->ie->evaluated_count += 1;
+    } else {
+        u64 *lhs = EvaluateSubtree(pass, node->lhs);
+        u64 *rhs = node->rhs ? EvaluateSubtree(pass, node->rhs) : NULL;
+
+        words = PushArray(pass->arena, pass->word_count, u64);
+        CombineSubtreeWords(node->op, lhs, rhs, words, pass->word_count);
+        pass->ie->evaluated_count += 1;
+    }
+
+    // NOTE(fcasibu): the recursion may have filled the cell we got before it, so look again
+    result = GetSubtreeResult(&pass->results, hash, node);
+    result->hash = hash;
+    result->node = node;
+    result->words = words;
+
+    return words;
+}
+
+// NOTE(fcasibu): Interpret for an expression that is being edited, always in source column order.
+// The table carries the parsed chunk for the heuristic minimizer and lives until the evaluation
+// after next.
+internal eval_result
+EvaluateIncremental(engine *e, incremental_evaluator *ie, const char *source)
+{
+    Assert(e);
+    Assert(ie);
+    Assert(source);
+
+    memory_arena *arena = &ie->arenas[ie->current ^ 1];
+    ArenaRecycle(arena);
+
+    chunk *c = PushStruct(arena, chunk);
+    ZeroStruct(c);
+    InitializeChunk(arena, c, 2048);
+    InitializeStringInternPool(&e->strings, arena, 10);
+    e->parser.strings = &e->strings;
+
+    b32 parsed = false;
+    ProfileBlock(e->profiler, Phase_Parse) {
+        parsed = Parse(&e->parser, arena, c, source);
+    }
+
+    if (!parsed)
+        return (eval_result){ Eval_ParseError, { NULL } };
+
+    // NOTE(fcasibu): a table this wide is only a BDD, there are no subtree words to keep for it
+    if (c->vars.size > DENSE_TABLE_MAX_VARS) {
+        bdd_ref bdd_root = BDD_FALSE;
+        bdd_manager *bdd = NULL;
+        ProfileBlock(e->profiler, Phase_Bdd) {
+            bdd = BuildSiftedBdd(arena, c, &bdd_root);
+        }
+
+        if (!bdd->overflowed) {
+            truth_table *table = PushTruthTable(arena, c);
+            table->bdd = bdd;
+            table->root = bdd_root;
+
+            ie->current ^= 1;
+            ie->valid = false;
+            ie->reused_count = 0;
+            ie->evaluated_count = 0;
+
+            return (eval_result){ Eval_Ok, { table } };
+        }
+    }
+
+    expr_node *root = e->parser.root;
+    expr_dag *dag = &e->parser.dag;
+
+    incremental_pass pass = { 0 };
+    pass.engine = e;
+    pass.arena = arena;
+    pass.ie = ie;
+    pass.dag = dag;
+    pass.vars = &c->vars;
+    pass.hashes = PushArray(arena, dag->node_count, u64);
+    pass.sizes = PushArray(arena, dag->node_count, u32);
+    ZeroArray(dag->node_count, pass.hashes);
+    ZeroArray(dag->node_count, pass.sizes);
+
+    HashSubtree(pass.hashes, root);
+    u32 tree_size = CountSubtreeNodes(pass.sizes, root);
+
+    u64 row_count = (u64)1 << c->vars.size;
+    pass.word_count = GetRowWordCount(row_count);
+
+    usize max_results = Max(INCREMENTAL_MAX_WORDS / pass.word_count, 1);
+    pass.leaf_nodes = Max(INCREMENTAL_LEAF_NODES, tree_size / max_results);
+    InitializeSubtreeResults(arena, &pass.results, dag->node_count);
+
+    if (ie->valid && !HasSameColumns(&ie->vars, &c->vars))
+        ie->valid = false;
+
+    ie->reused_count = 0;
+    ie->evaluated_count = 0;
+
+    u64 *words = NULL;
+    ProfileBlock(e->profiler, Phase_Evaluate) {
+        words = EvaluateSubtree(&pass, root);
+    }
+
+    truth_table *table = PushTruthTable(arena, c);
+    table->results.items = words;
+    table->results.size = pass.word_count;
+    table->results.capacity = pass.word_count;
+    table->chunk = c;
+
+    AddProfileRows(e->profiler, row_count);
+
+    ie->current ^= 1;
+    ie->valid = true;
+    ie->vars = table->vars;
+    ie->hashes = pass.hashes;
+    ie->results = pass.results;
+
+    return (eval_result){ Eval_Ok, { table } };
+}
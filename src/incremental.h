@@ -0,0 +1,43 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+// NOTE(fcasibu): live evaluation while the expression is edited. Subexpressions are matched
+// structurally against the previous evaluation and reuse its truth table words, so only the path
+// from the edit up to the root is recomputed. Subtrees of at most leaf_nodes nodes are compiled and
+// evaluated whole, larger ones are combined a word at a time from their operands.
+#define INCREMENTAL_LEAF_NODES 32
+
+// NOTE(fcasibu): the intermediate results are what gets cached, wide tables get larger leaves so
+// they stay under this many words
+#define INCREMENTAL_MAX_WORDS (MB(256) / sizeof(u64))
+#define INCREMENTAL_ARENA_SIZE MB(64)
+
+typedef struct {
+    u64 hash;
+    expr_node *node;
+    u64 *words;
+} subtree_result;
+
+// NOTE(fcasibu): open addressing keyed by the structural hash, a NULL node marks an empty cell
+typedef struct {
+    subtree_result *items;
+    usize capacity;
+} subtree_results;
+
+// NOTE(fcasibu): generations alternate between the two arenas. The current one holds the DAG,
+// hashes and results of the last successful evaluation along with the table it returned, a failed
+// parse leaves it alone so the next valid edit can still reuse it.
+typedef struct {
+    memory_arena arenas[2];
+    u32 current;
+
+    b32 valid;
+    references vars;
+    u64 *hashes;
+    subtree_results results;
+
+    usize reused_count;
+    usize evaluated_count;
+} incremental_evaluator;
+
+#endif // INCREMENTAL_H
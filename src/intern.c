@@ -1,41 +1,124 @@
-global string_intern_array StringInternArray;
+// NOTE(fcasibu): FNV-1a
+internal inline u32
+HashString(const char *str, usize length)
+{
+    u32 h = 2166136261u;
+    for (usize i = 0; i < length; ++i) {
+        h ^= (u8)str[i];
+        h *= 16777619u;
+    }
+
+    return h;
+}
 
 internal void
-InitializeStringInternPool(memory_arena *arena, usize initial_cap)
+InitializeInternTable(string_intern_array *pool, usize table_capacity)
 {
-    StringInternArray.capacity = initial_cap;
-    StringInternArray.size = 0;
-    StringInternArray.items = PushArray(arena, initial_cap, typeof(*StringInternArray.items));
-    StringInternArray.arena = arena;
+    Assert((table_capacity & (table_capacity - 1)) == 0);
 
-    Assert(StringInternArray.items);
+    pool->table_capacity = table_capacity;
+    pool->table = PushArray(pool->arena, table_capacity, u32);
+    Assert(pool->table);
+    ZeroArray(table_capacity, pool->table);
+
+    for (usize i = 0; i < pool->size; ++i) {
+        usize mask = table_capacity - 1;
+        usize at = pool->hashes[i] & mask;
+        while (pool->table[at])
+            at = (at + 1) & mask;
+
+        pool->table[at] = (u32)(i + 1);
+    }
 }
 
-internal i64
-GetInternedStringIdx(const char *str)
+internal void
+InitializeStringInternPool(string_intern_array *pool, memory_arena *arena, usize initial_cap)
+{
+    pool->capacity = initial_cap;
+    pool->size = 0;
+    pool->items = PushArray(arena, initial_cap, typeof(*pool->items));
+    pool->hashes = PushArray(arena, initial_cap, u32);
+    pool->arena = arena;
+
+    Assert(pool->items);
+    Assert(pool->hashes);
+
+    usize table_capacity = 16;
+    while (table_capacity < initial_cap * 2)
+        table_capacity *= 2;
+
+    InitializeInternTable(pool, table_capacity);
+}
+
+// NOTE(fcasibu): returns the table cell holding the match, or the empty cell where it would go
+internal u32 *
+FindInternCell(string_intern_array *pool, const char *str, usize length, u32 hash,
+               b32 match_pointer)
 {
-    for (usize i = 0; i < StringInternArray.size; ++i) {
-        if (str == StringInternArray.items[i])
-            return i;
+    usize mask = pool->table_capacity - 1;
+    usize at = hash & mask;
+
+    for (;;) {
+        u32 *cell = &pool->table[at];
+        if (!*cell)
+            return cell;
+
+        usize idx = *cell - 1;
+        const char *item = pool->items[idx];
+
+        if (pool->hashes[idx] == hash) {
+            if (match_pointer ? item == str
+                              : strncmp(item, str, length) == 0 && item[length] == '\0')
+                return cell;
+        }
+
+        at = (at + 1) & mask;
     }
+}
+
+internal i64
+GetInternedStringIdx(string_intern_array *pool, const char *str)
+{
+    Assert(str);
 
-    return -1;
+    u32 *cell = FindInternCell(pool, str, 0, HashString(str, strlen(str)), true);
+    return *cell ? (i64)*cell - 1 : -1;
 }
 
 internal const char *
-InternString(const char *str)
+InternStringN(string_intern_array *pool, const char *str, usize length)
 {
-    for (usize i = 0; i < StringInternArray.size; ++i) {
-        if (strcmp(StringInternArray.items[i], str) == 0)
-            return StringInternArray.items[i];
+    Assert(str);
+
+    u32 hash = HashString(str, length);
+    u32 *cell = FindInternCell(pool, str, length, hash, false);
+    if (*cell)
+        return pool->items[*cell - 1];
+
+    if (pool->size >= pool->capacity) {
+        usize old_capacity = pool->capacity;
+        GrowArray(pool->arena, pool);
+
+        u32 *hashes = PushArray(pool->arena, pool->capacity, u32);
+        Assert(hashes);
+        memcpy(hashes, pool->hashes, old_capacity * sizeof(*hashes));
+        pool->hashes = hashes;
     }
 
-    if (StringInternArray.size >= StringInternArray.capacity)
-        GrowArray(StringInternArray.arena, &StringInternArray);
+    Assert(pool->size < pool->capacity);
+
+    char *result = (char *)PushSize(pool->arena, length + 1);
+    memcpy(result, str, length);
+    result[length] = '\0';
+
+    usize idx = pool->size++;
+    pool->items[idx] = result;
+    pool->hashes[idx] = hash;
+    *cell = (u32)(idx + 1);
 
-    Assert(StringInternArray.size < StringInternArray.capacity);
-    char *result = PushString(StringInternArray.arena, str);
-    StringInternArray.items[StringInternArray.size++] = result;
+    // NOTE(fcasibu): load factor stays at or below 1/2
+    if (pool->size * 2 > pool->table_capacity)
+        InitializeInternTable(pool, pool->table_capacity * 2);
 
     return result;
 }
@@ -1,12 +1,18 @@
 #ifndef INTERN_H
 #define INTERN_H
 
-// TODO(fcasibu): Hashmap
+// NOTE(fcasibu): items keeps insertion order, so an index is stable for the life of the pool.
+// table is open addressed over item indices (index + 1, 0 is empty) with hashes[i] caching the
+// hash of items[i].
 typedef struct {
     const char **items;
+    u32 *hashes;
     usize size;
     usize capacity;
 
+    u32 *table;
+    usize table_capacity;
+
     memory_arena *arena;
 } string_intern_array;
 
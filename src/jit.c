@@ -0,0 +1,373 @@
+// NOTE(fcasibu): rdi holds the current word, rsi the end word and rdx the output pointer for the
+// whole loop, r10/r11 are scratch for variables that did not get a register of their own
+global_const x64_reg JIT_REGISTERS[] = {
+    X64_Rax, X64_Rcx, X64_R8,  X64_R9,  X64_Rbx,
+    X64_Rbp, X64_R12, X64_R13, X64_R14, X64_R15,
+};
+
+internal inline b32
+IsCalleeSaved(x64_reg r)
+{
+    return r == X64_Rbx || r == X64_Rbp || r >= X64_R12;
+}
+
+internal inline void
+EmitCode(jit_buffer *jb, const void *bytes, usize size)
+{
+    if (jb->used + size > jb->capacity) {
+        jb->overflowed = true;
+        return;
+    }
+
+    memcpy(jb->base + jb->used, bytes, size);
+    jb->used += size;
+}
+
+internal inline void
+EmitCode8(jit_buffer *jb, u8 byte)
+{
+    EmitCode(jb, &byte, sizeof(byte));
+}
+
+internal inline u8
+Rex(x64_reg reg, x64_reg rm)
+{
+    return 0x48 | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+}
+
+internal inline u8
+ModRM(u8 mod, u8 reg, u8 rm)
+{
+    return (u8)((mod << 6) | ((reg & 7) << 3) | (rm & 7));
+}
+
+// NOTE(fcasibu): <op> dst, src for the r/m64, r64 forms (mov 0x89, and 0x21, or 0x09, xor 0x31,
+// add 0x01, cmp 0x39)
+internal void
+EmitRegReg(jit_buffer *jb, u8 opcode, x64_reg dst, x64_reg src)
+{
+    u8 code[] = { Rex(src, dst), opcode, ModRM(3, src, dst) };
+    EmitCode(jb, code, sizeof(code));
+}
+
+internal inline void
+EmitMov(jit_buffer *jb, x64_reg dst, x64_reg src)
+{
+    if (dst != src)
+        EmitRegReg(jb, 0x89, dst, src);
+}
+
+// NOTE(fcasibu): not is /2, neg is /3
+internal void
+EmitUnary(jit_buffer *jb, u8 ext, x64_reg r)
+{
+    u8 code[] = { Rex(0, r), 0xF7, ModRM(3, ext, r) };
+    EmitCode(jb, code, sizeof(code));
+}
+
+// NOTE(fcasibu): add is /0, and is /4, the immediate is sign extended
+internal void
+EmitAluImm8(jit_buffer *jb, u8 ext, x64_reg r, i8 imm)
+{
+    u8 code[] = { Rex(0, r), 0x83, ModRM(3, ext, r), (u8)imm };
+    EmitCode(jb, code, sizeof(code));
+}
+
+internal void
+EmitShrImm8(jit_buffer *jb, x64_reg r, u8 imm)
+{
+    u8 code[] = { Rex(0, r), 0xC1, ModRM(3, 5, r), imm };
+    EmitCode(jb, code, sizeof(code));
+}
+
+internal void
+EmitMovImm64(jit_buffer *jb, x64_reg r, u64 imm)
+{
+    u8 code[] = { Rex(0, r), (u8)(0xB8 + (r & 7)) };
+    EmitCode(jb, code, sizeof(code));
+    EmitCode(jb, &imm, sizeof(imm));
+}
+
+internal void
+EmitPush(jit_buffer *jb, x64_reg r)
+{
+    if (r & 8)
+        EmitCode8(jb, 0x41);
+    EmitCode8(jb, 0x50 + (r & 7));
+}
+
+internal void
+EmitPop(jit_buffer *jb, x64_reg r)
+{
+    if (r & 8)
+        EmitCode8(jb, 0x41);
+    EmitCode8(jb, 0x58 + (r & 7));
+}
+
+// NOTE(fcasibu): jb is 0x2, jae is 0x3, returns where the rel32 lives so it can be patched
+internal usize
+EmitJcc(jit_buffer *jb, u8 condition, usize target)
+{
+    u8 code[] = { 0x0F, (u8)(0x80 + condition) };
+    EmitCode(jb, code, sizeof(code));
+
+    usize patch = jb->used;
+    i32 rel = (i32)(target - (jb->used + 4));
+    EmitCode(jb, &rel, sizeof(rel));
+
+    return patch;
+}
+
+internal void
+PatchJcc(jit_buffer *jb, usize patch, usize target)
+{
+    if (jb->overflowed)
+        return;
+
+    i32 rel = (i32)(target - (patch + 4));
+    memcpy(jb->base + patch, &rel, sizeof(rel));
+}
+
+// NOTE(fcasibu): same masks as OP_Var, row bit k of word w is bit k - 6 of w
+internal void
+EmitVarValue(jit_buffer *jb, x64_reg r, usize var_idx)
+{
+    if (var_idx < 6) {
+        EmitMovImm64(jb, r, VAR_PATTERNS[var_idx]);
+        return;
+    }
+
+    EmitMov(jb, r, X64_Rdi);
+    if (var_idx > 6)
+        EmitShrImm8(jb, r, (u8)(var_idx - 6));
+    EmitAluImm8(jb, 4, r, 1);
+    EmitUnary(jb, 3, r);
+}
+
+typedef struct {
+    jit_buffer *jb;
+    usize var_count;
+    x64_reg regs[MAX_REGISTERS];
+} jit_state;
+
+// NOTE(fcasibu): variables without a register are rebuilt into the scratch register on every use
+internal x64_reg
+GetOperand(jit_state *js, u8 reg, x64_reg scratch)
+{
+    if (js->regs[reg] != X64_None)
+        return js->regs[reg];
+
+    Assert(reg < js->var_count);
+    EmitVarValue(js->jb, scratch, reg);
+
+    return scratch;
+}
+
+internal void
+EmitInstruction(jit_state *js, instruction in)
+{
+    jit_buffer *jb = js->jb;
+    x64_reg d = js->regs[in.dst];
+
+    if (in.op == OP_False || in.op == OP_True) {
+        EmitRegReg(jb, 0x31, d, d);
+        if (in.op == OP_True)
+            EmitUnary(jb, 2, d);
+        return;
+    }
+
+    x64_reg a = GetOperand(js, in.a, X64_R10);
+    x64_reg b = in.op == OP_Not ? X64_None : GetOperand(js, in.b, X64_R11);
+
+    u8 opcode = 0;
+    b32 negate = false;
+
+    switch (in.op) {
+        case OP_And: {
+            opcode = 0x21;
+        } break;
+        case OP_Or: {
+            opcode = 0x09;
+        } break;
+        case OP_Xor: {
+            opcode = 0x31;
+        } break;
+        case OP_Nand: {
+            opcode = 0x21;
+            negate = true;
+        } break;
+        case OP_Nor: {
+            opcode = 0x09;
+            negate = true;
+        } break;
+        case OP_Xnor: {
+            opcode = 0x31;
+            negate = true;
+        } break;
+
+        case OP_Not: {
+            EmitMov(jb, d, a);
+            EmitUnary(jb, 2, d);
+        } return;
+
+        case OP_Imply: {
+            if (d == b) {
+                EmitMov(jb, X64_R10, a);
+                EmitUnary(jb, 2, X64_R10);
+                EmitRegReg(jb, 0x09, d, X64_R10);
+            } else {
+                EmitMov(jb, d, a);
+                EmitUnary(jb, 2, d);
+                EmitRegReg(jb, 0x09, d, b);
+            }
+        } return;
+
+            INVALID_DEFAULT_CASE;
+    }
+
+    if (d == b) {
+        EmitRegReg(jb, opcode, d, a);
+    } else {
+        EmitMov(jb, d, a);
+        EmitRegReg(jb, opcode, d, b);
+    }
+
+    if (negate)
+        EmitUnary(jb, 2, d);
+}
+
+internal void
+InitializeJITBuffer(jit_buffer *jb, usize capacity)
+{
+    Assert(jb);
+
+    jb->base = Platform.AllocateMemory(capacity);
+    jb->capacity = jb->base ? capacity : 0;
+    jb->used = 0;
+    jb->overflowed = false;
+}
+
+// NOTE(fcasibu): straight-line code for the register chunk inside a loop over words. Temporaries
+// always get a register, leftover registers go to the most used variables. A buffer only holds
+// one chunk at a time, compiling resets it.
+internal jit_fn *
+CompileNative(jit_buffer *jb, chunk *c)
+{
+    Assert(jb);
+    Assert(c);
+
+    if (!JIT_ENABLED || !Platform.ProtectMemory || !c->registers.lowered)
+        return NULL;
+
+    register_chunk *rc = &c->registers;
+    usize var_count = c->vars.size;
+    usize temp_count = rc->register_count - var_count;
+
+    if (temp_count > ArrayCount(JIT_REGISTERS))
+        return NULL;
+
+    if (!jb->base)
+        InitializeJITBuffer(jb, JIT_BUFFER_SIZE);
+
+    if (!jb->base || !Platform.ProtectMemory(jb->base, jb->capacity, false))
+        return NULL;
+
+    jb->used = 0;
+    jb->overflowed = false;
+
+    jit_state js = { 0 };
+    js.jb = jb;
+    js.var_count = var_count;
+
+    for (usize i = 0; i < ArrayCount(js.regs); ++i)
+        js.regs[i] = X64_None;
+
+    usize next_reg = 0;
+    for (usize i = 0; i < temp_count; ++i)
+        js.regs[var_count + i] = JIT_REGISTERS[next_reg++];
+
+    usize uses[MAX_VARS] = { 0 };
+    for (usize i = 0; i < rc->size; ++i) {
+        instruction in = rc->items[i];
+        if (in.op == OP_False || in.op == OP_True)
+            continue;
+
+        if (in.a < var_count)
+            uses[in.a] += 1;
+        if (in.op != OP_Not && in.b < var_count)
+            uses[in.b] += 1;
+    }
+
+    while (next_reg < ArrayCount(JIT_REGISTERS)) {
+        usize best = var_count;
+        for (usize k = 0; k < var_count; ++k) {
+            if (uses[k] && (best == var_count || uses[k] > uses[best]))
+                best = k;
+        }
+
+        if (best == var_count)
+            break;
+
+        js.regs[best] = JIT_REGISTERS[next_reg++];
+        uses[best] = 0;
+    }
+
+    for (usize i = 0; i < next_reg; ++i) {
+        if (IsCalleeSaved(JIT_REGISTERS[i]))
+            EmitPush(jb, JIT_REGISTERS[i]);
+    }
+
+    EmitRegReg(jb, 0x01, X64_Rsi, X64_Rdi);
+    EmitRegReg(jb, 0x39, X64_Rdi, X64_Rsi);
+    usize skip_loop = EmitJcc(jb, 0x3, 0);
+
+    for (usize k = 0; k < Min(var_count, 6); ++k) {
+        if (js.regs[k] != X64_None)
+            EmitVarValue(jb, js.regs[k], k);
+    }
+
+    usize loop = jb->used;
+
+    for (usize k = 6; k < var_count; ++k) {
+        if (js.regs[k] != X64_None)
+            EmitVarValue(jb, js.regs[k], k);
+    }
+
+    for (usize i = 0; i < rc->size; ++i)
+        EmitInstruction(&js, rc->items[i]);
+
+    x64_reg result = GetOperand(&js, rc->result, X64_R10);
+    u8 store[] = { Rex(result, X64_Rdx), 0x89, ModRM(0, result, X64_Rdx) };
+    EmitCode(jb, store, sizeof(store));
+
+    EmitAluImm8(jb, 0, X64_Rdx, 8);
+    EmitAluImm8(jb, 0, X64_Rdi, 1);
+    EmitRegReg(jb, 0x39, X64_Rdi, X64_Rsi);
+    EmitJcc(jb, 0x2, loop);
+
+    PatchJcc(jb, skip_loop, jb->used);
+
+    for (usize i = next_reg; i > 0; --i) {
+        if (IsCalleeSaved(JIT_REGISTERS[i - 1]))
+            EmitPop(jb, JIT_REGISTERS[i - 1]);
+    }
+    EmitCode8(jb, 0xC3);
+
+    if (!Platform.ProtectMemory(jb->base, jb->capacity, true) || jb->overflowed)
+        return NULL;
+
+    jit_fn *result_fn;
+    void *code = jb->base;
+    memcpy(&result_fn, &code, sizeof(result_fn));
+
+    return result_fn;
+}
+
+internal
+VM_KERNEL(RunNative)
+{
+    chunk *c = v->chunks;
+    Assert(c && c->native);
+
+    c->native(first_word, word_count, out);
+}
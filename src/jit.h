@@ -0,0 +1,33 @@
+#ifndef JIT_H
+#define JIT_H
+
+#if defined(__x86_64__) && !defined(DISABLE_JIT)
+#define JIT_ENABLED 1
+#else
+#define JIT_ENABLED 0
+#endif
+
+#define JIT_BUFFER_SIZE MB(1)
+
+// NOTE(fcasibu): System V calling convention, first_word in rdi, word_count in rsi, out in rdx
+#define JIT_FN(name) void name(u64 first_word, usize word_count, u64 *out)
+typedef JIT_FN(jit_fn);
+
+// clang-format off
+typedef Enum(u8, x64_reg){
+    X64_Rax, X64_Rcx, X64_Rdx, X64_Rbx, X64_Rsp, X64_Rbp, X64_Rsi, X64_Rdi,
+    X64_R8,  X64_R9,  X64_R10, X64_R11, X64_R12, X64_R13, X64_R14, X64_R15,
+
+    X64_None = 0xFF,
+};
+// clang-format on
+
+typedef struct {
+    u8 *base;
+    usize used;
+    usize capacity;
+
+    b32 overflowed;
+} jit_buffer;
+
+#endif // JIT_H
@@ -1,7 +1,5 @@
 #include <ctype.h>
 
-global lexer Lexer;
-
 global_const struct {
     const char *identifier;
     token_kind kind;
@@ -19,11 +17,11 @@ global_const struct {
 };
 
 internal void
-InitializeLexer(const char *source)
+InitializeLexer(lexer *l, const char *source)
 {
-    Lexer.lexeme_start = source;
-    Lexer.current_char = source;
-    Lexer.col = 1;
+    l->lexeme_start = source;
+    l->current_char = source;
+    l->col = 1;
 }
 
 internal token_kind
@@ -40,78 +38,78 @@ LookupReservedWord(const char *s)
 }
 
 internal inline token
-MakeToken(token_kind kind)
+MakeToken(lexer *l, token_kind kind)
 {
     token result = { 0 };
     result.kind = kind;
-    result.lexeme_start = Lexer.lexeme_start;
-    result.length = Lexer.current_char - Lexer.lexeme_start;
-    result.col = Lexer.col - result.length;
+    result.lexeme_start = l->lexeme_start;
+    result.length = l->current_char - l->lexeme_start;
+    result.col = l->col - result.length;
 
     return result;
 }
 
 internal inline char
-PeekLexer(void)
+PeekLexer(lexer *l)
 {
-    return *Lexer.current_char;
+    return *l->current_char;
 }
 
 internal inline char
-AdvanceLexer(void)
+AdvanceLexer(lexer *l)
 {
-    char c = *Lexer.current_char++;
-    Lexer.col += 1;
+    char c = *l->current_char++;
+    l->col += 1;
 
     return c;
 }
 
 internal token
-LexerIdentifier(void)
+LexerIdentifier(lexer *l)
 {
-    while (isalnum(PeekLexer()) && PeekLexer() != '\0')
-        AdvanceLexer();
+    while (isalnum(PeekLexer(l)) && PeekLexer(l) != '\0')
+        AdvanceLexer(l);
 
-    usize length = Lexer.current_char - Lexer.lexeme_start;
+    usize length = l->current_char - l->lexeme_start;
     char buf[length + 1];
-    strncpy(buf, Lexer.lexeme_start, length);
+    strncpy(buf, l->lexeme_start, length);
     buf[length] = '\0';
 
-    return MakeToken(LookupReservedWord(buf));
+    return MakeToken(l, LookupReservedWord(buf));
 }
 
 internal token
-ScanToken(void)
+ScanToken(lexer *l)
 {
     for (;;) {
-        char c = PeekLexer();
+        char c = PeekLexer(l);
         if (isspace(c)) {
-            AdvanceLexer();
+            AdvanceLexer(l);
         } else {
             break;
         }
     }
 
-    Lexer.lexeme_start = Lexer.current_char;
+    l->lexeme_start = l->current_char;
 
-    if (PeekLexer() == '\0')
-        return MakeToken(TokenKind_Eof);
+    if (PeekLexer(l) == '\0')
+        return MakeToken(l, TokenKind_Eof);
 
-    char ch = AdvanceLexer();
+    char ch = AdvanceLexer(l);
 
     switch (ch) {
         case '\0':
-            return MakeToken(TokenKind_Eof);
+            return MakeToken(l, TokenKind_Eof);
         case '(':
-            return MakeToken(TokenKind_LeftParen);
+            return MakeToken(l, TokenKind_LeftParen);
         case ')':
-            return MakeToken(TokenKind_RightParen);
+            return MakeToken(l, TokenKind_RightParen);
         default: {
             if (isalpha(ch))
-                return LexerIdentifier();
+                return LexerIdentifier(l);
 
             // TODO(fcasibu): Reporting
-            return MakeToken(TokenKind_Error);
+            return MakeToken(l, TokenKind_Error);
         };
     }
 }
@@ -1,4 +1,3 @@
-#include <sys/mman.h>
 #include <sys/stat.h>
 #include <dlfcn.h>
 #include <raylib.h>
@@ -6,6 +5,8 @@
 #include "base.h"
 #include "platform.h"
 
+#include "platform_posix.c"
+
 typedef struct {
     void *game_code_handle;
     i64 last_write_time;
@@ -68,25 +69,6 @@ ReloadGameCode(game_code *code, const char *source_lib_path)
     }
 }
 
-internal
-ALLOCATE_MEMORY(AllocateMemory)
-{
-    void *result = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
-
-    if (result == MAP_FAILED)
-        return NULL;
-
-    return result;
-}
-
-internal
-DEALLOCATE_MEMORY(DeallocateMemory)
-{
-    if (mem) {
-        munmap(mem, size);
-    }
-}
-
 internal void
 InitializeContext(context *ctx)
 {
@@ -100,6 +82,7 @@ InitializeContext(context *ctx)
     ctx->temporary_storage = (u8 *)ctx->permanent_storage + ctx->permanent_storage_size;
     ctx->platform.AllocateMemory = AllocateMemory;
     ctx->platform.DeallocateMemory = DeallocateMemory;
+    ctx->platform.ProtectMemory = ProtectMemory;
 }
 
 int
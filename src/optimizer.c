@@ -0,0 +1,296 @@
+internal inline b32
+IsConstant(const expr_node *node)
+{
+    return node->op == OP_False || node->op == OP_True;
+}
+
+internal inline b32
+IsComplement(const expr_node *a, const expr_node *b)
+{
+    return (a->op == OP_Not && a->lhs == b) || (b->op == OP_Not && b->lhs == a);
+}
+
+internal inline u8
+ApplyOp(op_code op, u8 a, u8 b)
+{
+    switch (op) {
+        case OP_And:
+            return a & b;
+        case OP_Or:
+            return a | b;
+        case OP_Xor:
+            return a ^ b;
+        case OP_Xnor:
+            return !(a ^ b);
+        case OP_Nand:
+            return !(a & b);
+        case OP_Nor:
+            return !(a | b);
+        case OP_Imply:
+            return (u8)((!a) | b);
+
+            INVALID_DEFAULT_CASE;
+    }
+
+    return 0;
+}
+
+// NOTE(fcasibu): NOT folded into the operator, 0 when there is no single opcode for it
+internal inline op_code
+GetNegatedOp(op_code op)
+{
+    switch (op) {
+        case OP_And:
+            return OP_Nand;
+        case OP_Nand:
+            return OP_And;
+        case OP_Or:
+            return OP_Nor;
+        case OP_Nor:
+            return OP_Or;
+        case OP_Xor:
+            return OP_Xnor;
+        case OP_Xnor:
+            return OP_Xor;
+
+        default:
+            return 0;
+    }
+}
+
+internal expr_node *MakeSimplifiedNode(memory_arena *arena, expr_dag *dag, op_code op,
+                                       expr_node *lhs, expr_node *rhs);
+
+internal inline expr_node *
+MakeConstant(memory_arena *arena, expr_dag *dag, u8 value)
+{
+    return MakeExprNode(arena, dag, value ? OP_True : OP_False, 0, NULL, NULL);
+}
+
+internal inline expr_node *
+MakeNot(memory_arena *arena, expr_dag *dag, expr_node *operand)
+{
+    return MakeSimplifiedNode(arena, dag, OP_Not, operand, NULL);
+}
+
+// NOTE(fcasibu): with one side fixed the operator is one of 0, 1, x or NOT x, which two
+// evaluations tell apart
+internal expr_node *
+FoldConstantOperand(memory_arena *arena, expr_dag *dag, op_code op, expr_node *lhs,
+                    expr_node *rhs)
+{
+    b32 constant_lhs = IsConstant(lhs);
+    u8 constant = (constant_lhs ? lhs : rhs)->op == OP_True;
+    expr_node *x = constant_lhs ? rhs : lhs;
+
+    u8 when_false = constant_lhs ? ApplyOp(op, constant, 0) : ApplyOp(op, 0, constant);
+    u8 when_true = constant_lhs ? ApplyOp(op, constant, 1) : ApplyOp(op, 1, constant);
+
+    if (when_false == when_true)
+        return MakeConstant(arena, dag, when_false);
+
+    return when_true ? x : MakeNot(arena, dag, x);
+}
+
+// NOTE(fcasibu): x op x and x op NOT x, a is x in the complement case
+internal expr_node *
+FoldSameOperand(memory_arena *arena, expr_dag *dag, op_code op, expr_node *x, b32 complement)
+{
+    u8 when_false = complement ? ApplyOp(op, 0, 1) : ApplyOp(op, 0, 0);
+    u8 when_true = complement ? ApplyOp(op, 1, 0) : ApplyOp(op, 1, 1);
+
+    if (when_false == when_true)
+        return MakeConstant(arena, dag, when_false);
+
+    return when_true ? x : MakeNot(arena, dag, x);
+}
+
+// NOTE(fcasibu): x AND (x OR y) = x, x OR (x AND y) = x, x AND (x AND y) = x AND y and the same
+// for OR
+internal expr_node *
+TryAbsorb(op_code op, expr_node *x, expr_node *other)
+{
+    if (op != OP_And && op != OP_Or)
+        return NULL;
+
+    if (other->lhs != x && other->rhs != x)
+        return NULL;
+
+    if (other->op == op)
+        return other;
+
+    op_code dual = op == OP_And ? OP_Or : OP_And;
+    if (other->op == dual)
+        return x;
+
+    return NULL;
+}
+
+// NOTE(fcasibu): NOT is pushed into the operator whenever both sides (or one side for XOR and
+// IMPLY) are negated, De Morgan turns the remaining cases into NAND/NOR
+internal expr_node *
+TryFuseNot(memory_arena *arena, expr_dag *dag, op_code op, expr_node *lhs, expr_node *rhs)
+{
+    b32 not_lhs = lhs->op == OP_Not;
+    b32 not_rhs = rhs->op == OP_Not;
+
+    if (not_lhs && not_rhs) {
+        switch (op) {
+            case OP_And:
+                return MakeSimplifiedNode(arena, dag, OP_Nor, lhs->lhs, rhs->lhs);
+            case OP_Or:
+                return MakeSimplifiedNode(arena, dag, OP_Nand, lhs->lhs, rhs->lhs);
+            case OP_Nand:
+                return MakeSimplifiedNode(arena, dag, OP_Or, lhs->lhs, rhs->lhs);
+            case OP_Nor:
+                return MakeSimplifiedNode(arena, dag, OP_And, lhs->lhs, rhs->lhs);
+            case OP_Xor:
+            case OP_Xnor:
+                return MakeSimplifiedNode(arena, dag, op, lhs->lhs, rhs->lhs);
+            case OP_Imply:
+                return MakeSimplifiedNode(arena, dag, OP_Imply, rhs->lhs, lhs->lhs);
+
+            default:
+                return NULL;
+        }
+    }
+
+    if (op == OP_Xor || op == OP_Xnor) {
+        if (not_lhs)
+            return MakeSimplifiedNode(arena, dag, GetNegatedOp(op), lhs->lhs, rhs);
+        if (not_rhs)
+            return MakeSimplifiedNode(arena, dag, GetNegatedOp(op), lhs, rhs->lhs);
+    }
+
+    if (op == OP_Imply) {
+        if (not_lhs)
+            return MakeSimplifiedNode(arena, dag, OP_Or, lhs->lhs, rhs);
+        if (not_rhs)
+            return MakeSimplifiedNode(arena, dag, OP_Nand, lhs, rhs->lhs);
+    }
+
+    return NULL;
+}
+
+// NOTE(fcasibu): every rewrite shrinks the node or removes a NOT, so the recursion terminates
+internal expr_node *
+MakeSimplifiedNode(memory_arena *arena, expr_dag *dag, op_code op, expr_node *lhs,
+                   expr_node *rhs)
+{
+    if (op == OP_Not) {
+        if (IsConstant(lhs))
+            return MakeConstant(arena, dag, lhs->op == OP_False);
+
+        if (lhs->op == OP_Not)
+            return lhs->lhs;
+
+        op_code negated = GetNegatedOp(lhs->op);
+        if (negated)
+            return MakeSimplifiedNode(arena, dag, negated, lhs->lhs, lhs->rhs);
+
+        return MakeExprNode(arena, dag, OP_Not, 0, lhs, NULL);
+    }
+
+    if (IsConstant(lhs) || IsConstant(rhs))
+        return FoldConstantOperand(arena, dag, op, lhs, rhs);
+
+    if (lhs == rhs)
+        return FoldSameOperand(arena, dag, op, lhs, false);
+
+    if (IsComplement(lhs, rhs)) {
+        // NOTE(fcasibu): only IMPLY cares which side is negated
+        b32 lhs_is_x = rhs->op == OP_Not && rhs->lhs == lhs;
+        expr_node *x = lhs_is_x ? lhs : rhs;
+
+        if (op == OP_Imply)
+            return lhs_is_x ? MakeNot(arena, dag, lhs) : rhs;
+
+        return FoldSameOperand(arena, dag, op, x, true);
+    }
+
+    expr_node *absorbed = TryAbsorb(op, lhs, rhs);
+    if (!absorbed)
+        absorbed = TryAbsorb(op, rhs, lhs);
+    if (absorbed)
+        return absorbed;
+
+    expr_node *fused = TryFuseNot(arena, dag, op, lhs, rhs);
+    if (fused)
+        return fused;
+
+    return MakeExprNode(arena, dag, op, 0, lhs, rhs);
+}
+
+// NOTE(fcasibu): decodes the stack code back into a DAG through the simplifying constructor and
+// emits it again, so folding, double negation, idempotence, complements, absorption and NOT
+// fusion all happen in a single pass over the chunk
+internal void
+OptimizeChunk(memory_arena *arena, chunk *c)
+{
+    Assert(arena);
+    Assert(c);
+
+    if (c->size == 0)
+        return;
+
+    expr_dag dag = { 0 };
+    InitializeExprDag(arena, &dag, c->size);
+
+    expr_node **stack = PushArray(arena, c->size, expr_node *);
+    expr_node *slots[MAX_SLOTS];
+    usize depth = 0;
+
+    u8 *ip = c->items;
+    u8 *end = c->items + c->size;
+
+    while (ip < end) {
+        op_code op = *ip++;
+
+        switch (op) {
+            case OP_Var: {
+                stack[depth++] = MakeExprNode(arena, &dag, OP_Var, *ip++, NULL, NULL);
+            } break;
+
+            case OP_Load: {
+                stack[depth++] = slots[*ip++];
+            } break;
+
+            case OP_Store: {
+                slots[*ip++] = stack[depth - 1];
+            } break;
+
+            case OP_False:
+            case OP_True: {
+                stack[depth++] = MakeExprNode(arena, &dag, op, 0, NULL, NULL);
+            } break;
+
+            case OP_Not: {
+                stack[depth - 1] = MakeNot(arena, &dag, stack[depth - 1]);
+            } break;
+
+            case OP_AndVar:
+            case OP_OrVar:
+            case OP_XorVar:
+            case OP_XnorVar:
+            case OP_NandVar:
+            case OP_NorVar:
+            case OP_ImplyVar: {
+                expr_node *var = MakeExprNode(arena, &dag, OP_Var, *ip++, NULL, NULL);
+                stack[depth - 1] =
+                    MakeSimplifiedNode(arena, &dag, GetBinaryOp(op), stack[depth - 1], var);
+            } break;
+
+            default: {
+                depth -= 1;
+                stack[depth - 1] =
+                    MakeSimplifiedNode(arena, &dag, op, stack[depth - 1], stack[depth]);
+            } break;
+        }
+    }
+
+    Assert(depth == 1);
+
+    c->size = 0;
+    c->slot_count = 0;
+    EmitDag(arena, c, &dag, stack[0]);
+}
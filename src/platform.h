@@ -7,9 +7,14 @@ typedef ALLOCATE_MEMORY(platform_allocate_memory);
 #define DEALLOCATE_MEMORY(name) void name(void *mem, usize size)
 typedef DEALLOCATE_MEMORY(platform_deallocate_memory);
 
+// NOTE(fcasibu): flips memory between read+write and read+execute
+#define PROTECT_MEMORY(name) b32 name(void *mem, usize size, b32 executable)
+typedef PROTECT_MEMORY(platform_protect_memory);
+
 typedef struct {
     platform_allocate_memory *AllocateMemory;
     platform_deallocate_memory *DeallocateMemory;
+    platform_protect_memory *ProtectMemory;
 } platform_api;
 
 global platform_api Platform;
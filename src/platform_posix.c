@@ -0,0 +1,27 @@
+#include <sys/mman.h>
+
+internal
+ALLOCATE_MEMORY(AllocateMemory)
+{
+    void *result = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+
+    if (result == MAP_FAILED)
+        return NULL;
+
+    return result;
+}
+
+internal
+DEALLOCATE_MEMORY(DeallocateMemory)
+{
+    if (mem) {
+        munmap(mem, size);
+    }
+}
+
+internal
+PROTECT_MEMORY(ProtectMemory)
+{
+    int protection = executable ? (PROT_READ | PROT_EXEC) : (PROT_READ | PROT_WRITE);
+    return mprotect(mem, size, protection) == 0;
+}
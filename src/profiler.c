@@ -0,0 +1,114 @@
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+internal inline u64
+ReadCycleCounter(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    u64 result;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(result));
+    return result;
+#else
+    return ReadMonotonicNanoseconds();
+#endif
+}
+
+maybe_unused internal void
+InitializeProfiler(profiler *p)
+{
+    Assert(p);
+
+    ZeroStruct(p);
+    p->anchor_cycles = ReadCycleCounter();
+    p->anchor_ns = ReadMonotonicNanoseconds();
+    p->frame_start = p->anchor_cycles;
+}
+
+internal inline profile_frame *
+GetCurrentProfileFrame(profiler *p)
+{
+    return &p->frames[p->frame_idx % PROFILER_FRAME_COUNT];
+}
+
+maybe_unused internal void
+BeginProfileFrame(profiler *p)
+{
+    if (!p)
+        return;
+
+    ZeroStruct(GetCurrentProfileFrame(p));
+    p->frame_start = ReadCycleCounter();
+}
+
+maybe_unused internal void
+EndProfileFrame(profiler *p)
+{
+    if (!p)
+        return;
+
+    u64 now = ReadCycleCounter();
+    profile_frame *frame = GetCurrentProfileFrame(p);
+    frame->frame_cycles = now - p->frame_start;
+
+    b32 did_work = frame->rows != 0;
+    for (usize i = 0; i < Phase_Count; ++i)
+        did_work |= frame->cycles[i] != 0;
+
+    if (did_work)
+        p->last_work = *frame;
+
+    // NOTE(fcasibu): the longer the window the better the estimate, it settles after a frame or two
+    u64 elapsed_ns = ReadMonotonicNanoseconds() - p->anchor_ns;
+    if (elapsed_ns > 0)
+        p->cycles_per_us = (f64)(now - p->anchor_cycles) * 1000.0 / (f64)elapsed_ns;
+
+    p->frame_idx += 1;
+}
+
+internal inline profile_block
+BeginProfileBlock(profiler *p, profile_phase phase)
+{
+    profile_block result = { .profiler = p, .phase = phase };
+    result.span = BeginTraceSpan(PROFILE_PHASE_NAMES[phase], NULL, 0, NULL, 0);
+    if (p)
+        result.start = ReadCycleCounter();
+
+    return result;
+}
+
+internal inline void
+EndProfileBlock(profile_block *block)
+{
+    block->done = true;
+    EndTraceSpan(&block->span);
+
+    if (block->profiler) {
+        profile_frame *frame = GetCurrentProfileFrame(block->profiler);
+        frame->cycles[block->phase] += ReadCycleCounter() - block->start;
+    }
+}
+
+internal inline void
+AddProfileRows(profiler *p, u64 rows)
+{
+    if (p)
+        GetCurrentProfileFrame(p)->rows += rows;
+}
+
+internal inline void
+RecordProfileArena(profiler *p, const memory_arena *arena)
+{
+    if (p) {
+        profile_frame *frame = GetCurrentProfileFrame(p);
+        frame->arena_bytes = Max(frame->arena_bytes, GetArenaUsed(arena));
+    }
+}
+
+internal inline f64
+GetProfileMicroseconds(const profiler *p, u64 cycles)
+{
+    return p->cycles_per_us > 0 ? (f64)cycles / p->cycles_per_us : 0;
+}
@@ -0,0 +1,61 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// NOTE(fcasibu): cycle counter timers around the evaluation phases. Lexing is pulled by the parser
+// so the two are one phase.
+typedef Enum(u8, profile_phase){
+    Phase_Parse,
+    Phase_Optimize,
+    Phase_Bdd,
+    Phase_Lower,
+    Phase_Jit,
+    Phase_Evaluate,
+    Phase_Simplify,
+
+    Phase_Count,
+};
+
+global_const char *const PROFILE_PHASE_NAMES[Phase_Count] = {
+    "parse", "optimize", "bdd", "lower", "jit", "evaluate", "simplify",
+};
+
+#define PROFILER_FRAME_COUNT 128
+
+typedef struct {
+    u64 frame_cycles;
+    u64 cycles[Phase_Count];
+    u64 rows;
+    usize arena_bytes;
+} profile_frame;
+
+// NOTE(fcasibu): one frame per BeginProfileFrame/EndProfileFrame pair, frames[frame_idx %
+// PROFILER_FRAME_COUNT] is the one being recorded. Most frames evaluate nothing, last_work keeps
+// the latest frame that did. Not thread safe, the batch pipeline runs without one.
+typedef struct {
+    profile_frame frames[PROFILER_FRAME_COUNT];
+    u64 frame_idx;
+    u64 frame_start;
+
+    profile_frame last_work;
+
+    // NOTE(fcasibu): the counter rate is measured against the monotonic clock since initialization
+    u64 anchor_cycles;
+    u64 anchor_ns;
+    f64 cycles_per_us;
+} profiler;
+
+// NOTE(fcasibu): phases are also trace spans, so they show up in a trace without a profiler
+typedef struct {
+    profiler *profiler;
+    profile_phase phase;
+    u64 start;
+    trace_span span;
+    b32 done;
+} profile_block;
+
+// NOTE(fcasibu): times the statement or block that follows, a return out of it is not recorded
+#define ProfileBlock(p, phase)                                                                \
+    for (profile_block block_ = BeginProfileBlock((p), (phase)); !block_.done;               \
+         EndProfileBlock(&block_))
+
+#endif // PROFILER_H
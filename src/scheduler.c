@@ -0,0 +1,165 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+typedef struct {
+    work_queue *queue;
+    usize worker_idx;
+} worker_context;
+
+internal inline u64
+PackRange(u32 begin, u32 end)
+{
+    return ((u64)end << 32) | begin;
+}
+
+internal inline u32
+RangeBegin(u64 range)
+{
+    return (u32)range;
+}
+
+internal inline u32
+RangeEnd(u64 range)
+{
+    return (u32)(range >> 32);
+}
+
+internal usize
+GetWorkerCount(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (count < 1)
+        return 1;
+
+    return Min((usize)count, MAX_WORKERS);
+}
+
+// NOTE(fcasibu): only the owner moves begin forward
+internal b32
+PopWork(work_range *r, u64 *item_idx)
+{
+    u64 range = atomic_load(&r->range);
+
+    for (;;) {
+        u32 begin = RangeBegin(range);
+        u32 end = RangeEnd(range);
+
+        if (begin >= end)
+            return false;
+
+        if (atomic_compare_exchange_weak(&r->range, &range, PackRange(begin + 1, end))) {
+            *item_idx = begin;
+            return true;
+        }
+    }
+}
+
+// NOTE(fcasibu): thieves only move end backwards, taking the upper half of the fullest range.
+// The thief's own range is empty while it steals, so nobody else touches it and a plain store
+// hands it the stolen items.
+internal b32
+StealWork(work_queue *queue, usize thief_idx)
+{
+    for (;;) {
+        work_range *victim = NULL;
+        u64 victim_range = 0;
+        u32 most_remaining = 0;
+
+        for (usize i = 0; i < queue->worker_count; ++i) {
+            if (i == thief_idx)
+                continue;
+
+            u64 range = atomic_load(&queue->ranges[i].range);
+            u32 remaining = RangeEnd(range) - RangeBegin(range);
+
+            if (remaining > most_remaining) {
+                victim = &queue->ranges[i];
+                victim_range = range;
+                most_remaining = remaining;
+            }
+        }
+
+        if (!victim)
+            return false;
+
+        u32 begin = RangeBegin(victim_range);
+        u32 end = RangeEnd(victim_range);
+        u32 mid = end - (most_remaining + 1) / 2;
+
+        if (atomic_compare_exchange_weak(&victim->range, &victim_range, PackRange(begin, mid))) {
+            atomic_store(&queue->ranges[thief_idx].range, PackRange(mid, end));
+            return true;
+        }
+    }
+}
+
+internal void
+DrainWorkQueue(work_queue *queue, usize worker_idx)
+{
+    work_range *own = &queue->ranges[worker_idx];
+
+    for (;;) {
+        u64 item_idx;
+
+        if (PopWork(own, &item_idx)) {
+            queue->Proc(queue->user, worker_idx, item_idx);
+        } else if (!StealWork(queue, worker_idx)) {
+            break;
+        }
+    }
+}
+
+internal void *
+WorkerThread(void *param)
+{
+    worker_context *worker = (worker_context *)param;
+    SetTraceThreadId(TRACE_WORKER_THREAD_BASE + (u32)worker->worker_idx);
+
+    DrainWorkQueue(worker->queue, worker->worker_idx);
+
+    return NULL;
+}
+
+// NOTE(fcasibu): the calling thread is worker 0, returns once every item has been processed
+internal void
+RunWorkQueue(work_queue *queue, u64 item_count, usize worker_count, worker_proc *Proc, void *user)
+{
+    Assert(queue);
+    Assert(Proc);
+    Assert(item_count <= UINT32_MAX);
+
+    worker_count = Max(Min(worker_count, MAX_WORKERS), 1);
+
+    queue->worker_count = worker_count;
+    queue->Proc = Proc;
+    queue->user = user;
+
+    u64 per_worker = item_count / worker_count;
+    u64 leftover = item_count % worker_count;
+    u64 begin = 0;
+
+    for (usize i = 0; i < worker_count; ++i) {
+        u64 end = begin + per_worker + (i < leftover ? 1 : 0);
+        atomic_store(&queue->ranges[i].range, PackRange((u32)begin, (u32)end));
+        begin = end;
+    }
+
+    worker_context workers[MAX_WORKERS];
+    pthread_t threads[MAX_WORKERS];
+    usize spawned = 1;
+
+    for (usize i = 1; i < worker_count; ++i) {
+        workers[i] = (worker_context){ queue, i };
+        if (pthread_create(&threads[i], NULL, WorkerThread, &workers[i]) != 0)
+            break;
+
+        spawned += 1;
+    }
+
+    // NOTE(fcasibu): ranges of threads that failed to start get stolen by the rest
+    DrainWorkQueue(queue, 0);
+
+    for (usize i = 1; i < spawned; ++i)
+        pthread_join(threads[i], NULL);
+}
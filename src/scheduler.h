@@ -0,0 +1,23 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#define MAX_WORKERS 64
+
+// NOTE(fcasibu): [begin, end) packed into one word (begin low, end high) so popping and stealing
+// are a single CAS each. Padded so workers never share a cache line.
+typedef struct {
+    alignas(64) _Atomic u64 range;
+} work_range;
+
+#define WORKER_PROC(name) void name(void *user, usize worker_idx, u64 item_idx)
+typedef WORKER_PROC(worker_proc);
+
+typedef struct {
+    work_range ranges[MAX_WORKERS];
+    usize worker_count;
+
+    worker_proc *Proc;
+    void *user;
+} work_queue;
+
+#endif // SCHEDULER_H
@@ -0,0 +1,133 @@
+#include <stdatomic.h>
+#include <time.h>
+
+global _Thread_local u32 TraceThreadId;
+
+internal inline u64
+ReadMonotonicNanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec * 1000000000ULL + (u64)ts.tv_nsec;
+}
+
+maybe_unused internal b32
+InitializeTrace(trace_log *t, usize capacity)
+{
+    Assert(t);
+
+    t->events = Platform.AllocateMemory(capacity * sizeof(trace_event));
+    if (!t->events)
+        return false;
+
+    t->capacity = capacity;
+    atomic_store(&t->count, 0);
+    atomic_store(&t->next_thread_id, 1);
+    t->start_ns = ReadMonotonicNanoseconds();
+
+    return true;
+}
+
+maybe_unused internal void
+ReleaseTrace(trace_log *t)
+{
+    if (t->events)
+        Platform.DeallocateMemory(t->events, t->capacity * sizeof(trace_event));
+
+    t->events = NULL;
+    t->capacity = 0;
+}
+
+internal inline void
+SetTraceThreadId(u32 thread_id)
+{
+    TraceThreadId = thread_id;
+}
+
+internal inline u32
+GetTraceThreadId(trace_log *t)
+{
+    if (!TraceThreadId)
+        TraceThreadId = atomic_fetch_add(&t->next_thread_id, 1);
+
+    return TraceThreadId;
+}
+
+internal inline trace_span
+BeginTraceSpan(const char *name, const char *arg0_name, u64 arg0, const char *arg1_name, u64 arg1)
+{
+    trace_span result = { .name = name };
+    if (Trace) {
+        result.args[0] = (trace_arg){ arg0_name, arg0 };
+        result.args[1] = (trace_arg){ arg1_name, arg1 };
+        result.start_ns = ReadMonotonicNanoseconds();
+    }
+
+    return result;
+}
+
+// NOTE(fcasibu): slots are claimed with one atomic add, events past the capacity are dropped and
+// only counted
+internal inline void
+EndTraceSpan(trace_span *span)
+{
+    span->done = true;
+
+    trace_log *t = Trace;
+    if (!t || !span->start_ns)
+        return;
+
+    u64 end_ns = ReadMonotonicNanoseconds();
+    usize idx = atomic_fetch_add(&t->count, 1);
+    if (idx >= t->capacity)
+        return;
+
+    trace_event *event = &t->events[idx];
+    event->name = span->name;
+    event->start_ns = span->start_ns;
+    event->duration_ns = end_ns - span->start_ns;
+    event->thread_id = GetTraceThreadId(t);
+    event->args[0] = span->args[0];
+    event->args[1] = span->args[1];
+}
+
+// NOTE(fcasibu): complete ("X") events with microsecond timestamps relative to InitializeTrace, the
+// viewer sorts them so the order they were recorded in does not matter. Call once every thread
+// that records has finished.
+maybe_unused internal void
+WriteTrace(trace_log *t, FILE *out)
+{
+    usize count = Min(atomic_load(&t->count), t->capacity);
+
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+
+    for (usize i = 0; i < count; ++i) {
+        trace_event *event = &t->events[i];
+        f64 ts = (f64)(event->start_ns - t->start_ns) / 1000.0;
+        f64 dur = (f64)event->duration_ns / 1000.0;
+
+        fprintf(out,
+                "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, "
+                "\"dur\": %.3f, \"args\": {",
+                i ? ",\n" : "", event->name, event->thread_id, ts, dur);
+
+        b32 first_arg = true;
+        for (usize k = 0; k < ArrayCount(event->args); ++k) {
+            if (!event->args[k].name)
+                continue;
+
+            fprintf(out, "%s\"%s\": %llu", first_arg ? "" : ", ", event->args[k].name,
+                    (unsigned long long)event->args[k].value);
+            first_arg = false;
+        }
+
+        fprintf(out, "}}");
+    }
+
+    fprintf(out, "\n]}\n");
+
+    usize total = atomic_load(&t->count);
+    if (total > t->capacity)
+        fprintf(stderr, "trace: dropped %zu of %zu events\n", total - t->capacity, total);
+}
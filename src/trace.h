@@ -0,0 +1,50 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// NOTE(fcasibu): spans in the Chrome trace-event format, for loading long batch runs into a trace
+// viewer. Tracing is process wide like Platform, arena growth and the worker threads have no engine
+// to reach it through, and nothing is recorded while Trace is NULL.
+#define TRACE_MAX_EVENTS (1 << 20)
+
+// NOTE(fcasibu): workers get a fixed id per worker index instead of one per spawned thread, so a
+// batch run shows one row per worker rather than thousands of short-lived threads
+#define TRACE_WORKER_THREAD_BASE 100
+
+typedef struct {
+    const char *name;
+    u64 value;
+} trace_arg;
+
+// NOTE(fcasibu): names and arg names are expected to be string literals, only the pointers are kept
+typedef struct {
+    const char *name;
+    u64 start_ns;
+    u64 duration_ns;
+    u32 thread_id;
+    trace_arg args[2];
+} trace_event;
+
+typedef struct {
+    trace_event *events;
+    usize capacity;
+    _Atomic usize count;
+
+    _Atomic u32 next_thread_id;
+    u64 start_ns;
+} trace_log;
+
+global trace_log *Trace;
+
+typedef struct {
+    const char *name;
+    u64 start_ns;
+    trace_arg args[2];
+    b32 done;
+} trace_span;
+
+// NOTE(fcasibu): traces the statement or block that follows, a return out of it is not recorded
+#define TraceBlock(name, arg0_name, arg0, arg1_name, arg1)                                    \
+    for (trace_span span_ = BeginTraceSpan((name), (arg0_name), (arg0), (arg1_name), (arg1));  \
+         !span_.done; EndTraceSpan(&span_))
+
+#endif // TRACE_H
@@ -1,112 +1,514 @@
-global vm VM;
+// NOTE(fcasibu): inside an aligned lane of lane_words words the first 6 + log2(lane_words)
+// variables always follow the same pattern, the rest are uniform across the lane
+internal void
+GetVarPattern(usize var_idx, usize lane_words, u64 *words)
+{
+    for (usize l = 0; l < lane_words; ++l) {
+        if (var_idx < 6)
+            words[l] = VAR_PATTERNS[var_idx];
+        else
+            words[l] = ((l >> (var_idx - 6)) & 1) ? ~(u64)0 : 0;
+    }
+}
+
+// NOTE(fcasibu): value of a variable inside DEFINE_VM_KERNEL, expects patterns, pattern_vars and
+// row_idx in scope
+#define VM_VAR_LANE(lane, var_idx)                                                             \
+    ((var_idx) < pattern_vars ? patterns[(var_idx)]                                            \
+                              : (lane){ 0 } + (((row_idx >> (var_idx)) & 1) ? ~(u64)0 : 0))
+
+// NOTE(fcasibu): the kernels either dispatch through a switch or, with VM_THREADED_DISPATCH,
+// jump straight from the end of one handler to the next through a table of label addresses so
+// every handler gets its own indirect branch. The stack kernels fetch an op byte, the register
+// kernels a whole instruction into in.
+#if VM_THREADED_DISPATCH
+#define VM_DISPATCH_TABLE                                                                      \
+    [OP_Var] = &&vm_OP_Var, [OP_And] = &&vm_OP_And, [OP_Or] = &&vm_OP_Or,                      \
+    [OP_Xor] = &&vm_OP_Xor, [OP_Xnor] = &&vm_OP_Xnor, [OP_Not] = &&vm_OP_Not,                  \
+    [OP_Nand] = &&vm_OP_Nand, [OP_Nor] = &&vm_OP_Nor, [OP_Imply] = &&vm_OP_Imply,              \
+    [OP_Load] = &&vm_OP_Load, [OP_Store] = &&vm_OP_Store, [OP_False] = &&vm_OP_False,          \
+    [OP_True] = &&vm_OP_True, [OP_AndVar] = &&vm_OP_AndVar, [OP_OrVar] = &&vm_OP_OrVar,        \
+    [OP_XorVar] = &&vm_OP_XorVar, [OP_XnorVar] = &&vm_OP_XnorVar,                              \
+    [OP_NandVar] = &&vm_OP_NandVar, [OP_NorVar] = &&vm_OP_NorVar,                              \
+    [OP_ImplyVar] = &&vm_OP_ImplyVar
+
+#define VM_REGISTER_DISPATCH_TABLE                                                             \
+    [OP_And] = &&vm_OP_And, [OP_Or] = &&vm_OP_Or, [OP_Xor] = &&vm_OP_Xor,                      \
+    [OP_Xnor] = &&vm_OP_Xnor, [OP_Not] = &&vm_OP_Not, [OP_Nand] = &&vm_OP_Nand,                \
+    [OP_Nor] = &&vm_OP_Nor, [OP_Imply] = &&vm_OP_Imply, [OP_False] = &&vm_OP_False,            \
+    [OP_True] = &&vm_OP_True
+
+#define VM_DISPATCH(ip, end)                                                                   \
+    static const void *const dispatch[] = { VM_DISPATCH_TABLE };                               \
+    if ((ip) < (end))                                                                          \
+        goto *dispatch[*(ip)++];                                                               \
+    goto vm_dispatch_end;
+#define VM_NEXT(ip, end)                                                                       \
+    if ((ip) < (end))                                                                          \
+        goto *dispatch[*(ip)++];                                                               \
+    goto vm_dispatch_end
+#define VM_REGISTER_DISPATCH(ip, end, in)                                                      \
+    static const void *const dispatch[] = { VM_REGISTER_DISPATCH_TABLE };                      \
+    if ((ip) < (end))                                                                          \
+        goto *dispatch[((in) = *(ip)++).op];                                                   \
+    goto vm_dispatch_end;
+#define VM_REGISTER_NEXT(ip, end, in)                                                          \
+    if ((ip) < (end))                                                                          \
+        goto *dispatch[((in) = *(ip)++).op];                                                   \
+    goto vm_dispatch_end
+#define VM_CASE(op) vm_##op:
+#define VM_INVALID_CASE
+#define VM_DISPATCH_END vm_dispatch_end:
+#else
+#define VM_DISPATCH(ip, end) while ((ip) < (end)) switch (*(ip)++)
+#define VM_NEXT(ip, end) break
+#define VM_REGISTER_DISPATCH(ip, end, in) while ((ip) < (end)) switch (((in) = *(ip)++).op)
+#define VM_REGISTER_NEXT(ip, end, in) break
+#define VM_CASE(op) case op:
+#define VM_INVALID_CASE INVALID_DEFAULT_CASE
+#define VM_DISPATCH_END
+#endif
+
+// NOTE(fcasibu): one interpreter body for every lane width, a lane is (1 << lane_shift) words.
+// Pattern variables come from a table built once per call, the rest are splatted from the row
+// index. The table loop repeats its bound because gcc loses it when it peels the loop from a
+// profile, and then warns about the memcpy.
+#define DEFINE_VM_KERNEL(name, lane, lane_shift, attributes)                                   \
+    attributes internal VM_KERNEL(name)                                                        \
+    {                                                                                          \
+        chunk *c = v->chunks;                                                                  \
+        Assert(c);                                                                             \
+                                                                                               \
+        usize lane_words = (usize)1 << (lane_shift);                                           \
+        Assert((first_word & (lane_words - 1)) == 0);                                          \
+        Assert((c->slot_count + c->max_depth) * lane_words <= v->stack_size);                  \
+                                                                                               \
+        lane patterns[6 + (lane_shift)];                                                       \
+        usize pattern_vars = Min(ArrayCount(patterns), c->vars.size);                          \
+                                                                                               \
+        for (usize k = 0; k < pattern_vars && k < ArrayCount(patterns); ++k) {                 \
+            u64 words[1 << (lane_shift)];                                                      \
+            GetVarPattern(k, lane_words, words);                                               \
+            memcpy(&patterns[k], words, sizeof(lane));                                         \
+        }                                                                                      \
+                                                                                               \
+        usize wide_count = word_count & ~(lane_words - 1);                                     \
+                                                                                               \
+        for (usize w = 0; w < wide_count; w += lane_words) {                                   \
+            u64 row_idx = (first_word + w) * 64;                                               \
+                                                                                               \
+            u8 *ip = c->items;                                                                 \
+            u8 *end = c->items + c->size;                                                      \
+            lane *slots = (lane *)v->stack;                                                    \
+            lane *sp = slots + c->slot_count;                                                  \
+                                                                                               \
+            VM_DISPATCH(ip, end) {                                                             \
+                VM_CASE(OP_Var) {                                                              \
+                    u8 var_idx = *ip++;                                                        \
+                    *sp++ = VM_VAR_LANE(lane, var_idx);                                        \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Load) {                                                             \
+                    u8 slot = *ip++;                                                           \
+                    *sp++ = slots[slot];                                                       \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Store) {                                                            \
+                    u8 slot = *ip++;                                                           \
+                    slots[slot] = *(sp - 1);                                                   \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_False) {                                                            \
+                    *sp++ = (lane){ 0 };                                                       \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_True) {                                                             \
+                    *sp++ = ~(lane){ 0 };                                                      \
+                } VM_NEXT(ip, end);                                                            \
+                                                                                               \
+                VM_CASE(OP_And) {                                                              \
+                    lane b = *--sp;                                                            \
+                    lane a = *--sp;                                                            \
+                    *sp++ = a & b;                                                             \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Or) {                                                               \
+                    lane b = *--sp;                                                            \
+                    lane a = *--sp;                                                            \
+                    *sp++ = a | b;                                                             \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Xor) {                                                              \
+                    lane b = *--sp;                                                            \
+                    lane a = *--sp;                                                            \
+                    *sp++ = a ^ b;                                                             \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Not) {                                                              \
+                    lane a = *--sp;                                                            \
+                    *sp++ = ~a;                                                                \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Imply) {                                                            \
+                    lane b = *--sp;                                                            \
+                    lane a = *--sp;                                                            \
+                    *sp++ = (~a) | b;                                                          \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Nand) {                                                             \
+                    lane b = *--sp;                                                            \
+                    lane a = *--sp;                                                            \
+                    *sp++ = ~(a & b);                                                          \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Nor) {                                                              \
+                    lane b = *--sp;                                                            \
+                    lane a = *--sp;                                                            \
+                    *sp++ = ~(a | b);                                                          \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_Xnor) {                                                             \
+                    lane b = *--sp;                                                            \
+                    lane a = *--sp;                                                            \
+                    *sp++ = ~(a ^ b);                                                          \
+                } VM_NEXT(ip, end);                                                            \
+                                                                                               \
+                VM_CASE(OP_AndVar) {                                                           \
+                    u8 var_idx = *ip++;                                                        \
+                    lane b = VM_VAR_LANE(lane, var_idx);                                       \
+                    lane a = *(sp - 1);                                                        \
+                    *(sp - 1) = a & b;                                                         \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_OrVar) {                                                            \
+                    u8 var_idx = *ip++;                                                        \
+                    lane b = VM_VAR_LANE(lane, var_idx);                                       \
+                    lane a = *(sp - 1);                                                        \
+                    *(sp - 1) = a | b;                                                         \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_XorVar) {                                                           \
+                    u8 var_idx = *ip++;                                                        \
+                    lane b = VM_VAR_LANE(lane, var_idx);                                       \
+                    lane a = *(sp - 1);                                                        \
+                    *(sp - 1) = a ^ b;                                                         \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_XnorVar) {                                                          \
+                    u8 var_idx = *ip++;                                                        \
+                    lane b = VM_VAR_LANE(lane, var_idx);                                       \
+                    lane a = *(sp - 1);                                                        \
+                    *(sp - 1) = ~(a ^ b);                                                      \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_NandVar) {                                                          \
+                    u8 var_idx = *ip++;                                                        \
+                    lane b = VM_VAR_LANE(lane, var_idx);                                       \
+                    lane a = *(sp - 1);                                                        \
+                    *(sp - 1) = ~(a & b);                                                      \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_NorVar) {                                                           \
+                    u8 var_idx = *ip++;                                                        \
+                    lane b = VM_VAR_LANE(lane, var_idx);                                       \
+                    lane a = *(sp - 1);                                                        \
+                    *(sp - 1) = ~(a | b);                                                      \
+                } VM_NEXT(ip, end);                                                            \
+                VM_CASE(OP_ImplyVar) {                                                         \
+                    u8 var_idx = *ip++;                                                        \
+                    lane b = VM_VAR_LANE(lane, var_idx);                                       \
+                    lane a = *(sp - 1);                                                        \
+                    *(sp - 1) = (~a) | b;                                                      \
+                } VM_NEXT(ip, end);                                                            \
+            }                                                                                  \
+            VM_DISPATCH_END;                                                                   \
+                                                                                               \
+            memcpy(out + w, sp - 1, sizeof(lane));                                             \
+        }                                                                                      \
+                                                                                               \
+        if (wide_count < word_count)                                                           \
+            RunVM(v, first_word + wide_count, word_count - wide_count, out + wide_count);      \
+    }
+
+// NOTE(fcasibu): same lanes as DEFINE_VM_KERNEL but over the register_chunk. The register file
+// starts with the variables, so operators read them directly and only the uniform variables
+// whose row bit flipped since the previous lane get rewritten.
+#define DEFINE_REGISTER_KERNEL(name, lane, lane_shift, attributes)                             \
+    attributes internal VM_KERNEL(name)                                                        \
+    {                                                                                          \
+        chunk *c = v->chunks;                                                                  \
+        Assert(c && c->registers.lowered);                                                     \
+                                                                                               \
+        register_chunk *rc = &c->registers;                                                    \
+        usize lane_words = (usize)1 << (lane_shift);                                           \
+        Assert((first_word & (lane_words - 1)) == 0);                                          \
+                                                                                               \
+        lane regs[MAX_REGISTERS];                                                              \
+        usize pattern_vars = Min(6 + (lane_shift), c->vars.size);                              \
+                                                                                               \
+        for (usize k = 0; k < pattern_vars; ++k) {                                             \
+            u64 words[1 << (lane_shift)];                                                      \
+            GetVarPattern(k, lane_words, words);                                               \
+            memcpy(&regs[k], words, sizeof(lane));                                             \
+        }                                                                                      \
+                                                                                               \
+        u64 uniform_vars = (((u64)1 << c->vars.size) - 1) & ~(((u64)1 << pattern_vars) - 1);   \
+        u64 prev_row_idx = first_word * 64;                                                    \
+                                                                                               \
+        for (usize k = pattern_vars; k < c->vars.size; ++k)                                    \
+            regs[k] = (lane){ 0 } + (((prev_row_idx >> k) & 1) ? ~(u64)0 : 0);                 \
+                                                                                               \
+        usize wide_count = word_count & ~(lane_words - 1);                                     \
+                                                                                               \
+        for (usize w = 0; w < wide_count; w += lane_words) {                                   \
+            u64 row_idx = (first_word + w) * 64;                                               \
+            u64 flipped = (row_idx ^ prev_row_idx) & uniform_vars;                             \
+            prev_row_idx = row_idx;                                                            \
+                                                                                               \
+            while (flipped) {                                                                  \
+                usize k = __builtin_ctzll(flipped);                                            \
+                regs[k] = (lane){ 0 } + (((row_idx >> k) & 1) ? ~(u64)0 : 0);                  \
+                flipped &= flipped - 1;                                                        \
+            }                                                                                  \
+                                                                                               \
+            instruction *ip = rc->items;                                                       \
+            instruction *end = rc->items + rc->size;                                           \
+            instruction in;                                                                    \
+                                                                                               \
+            VM_REGISTER_DISPATCH(ip, end, in) {                                                \
+                VM_CASE(OP_And) {                                                              \
+                    regs[in.dst] = regs[in.a] & regs[in.b];                                    \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_Or) {                                                               \
+                    regs[in.dst] = regs[in.a] | regs[in.b];                                    \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_Xor) {                                                              \
+                    regs[in.dst] = regs[in.a] ^ regs[in.b];                                    \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_Not) {                                                              \
+                    regs[in.dst] = ~regs[in.a];                                                \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_Imply) {                                                            \
+                    regs[in.dst] = (~regs[in.a]) | regs[in.b];                                 \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_Nand) {                                                             \
+                    regs[in.dst] = ~(regs[in.a] & regs[in.b]);                                 \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_Nor) {                                                              \
+                    regs[in.dst] = ~(regs[in.a] | regs[in.b]);                                 \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_Xnor) {                                                             \
+                    regs[in.dst] = ~(regs[in.a] ^ regs[in.b]);                                 \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_False) {                                                            \
+                    regs[in.dst] = (lane){ 0 };                                                \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                VM_CASE(OP_True) {                                                             \
+                    regs[in.dst] = ~(lane){ 0 };                                               \
+                } VM_REGISTER_NEXT(ip, end, in);                                               \
+                                                                                               \
+                VM_INVALID_CASE;                                                               \
+            }                                                                                  \
+            VM_DISPATCH_END;                                                                   \
+                                                                                               \
+            memcpy(out + w, &regs[rc->result], sizeof(lane));                                  \
+        }                                                                                      \
+                                                                                               \
+        if (wide_count < word_count) {                                                         \
+            usize rest = word_count - wide_count;                                              \
+            RunRegisterVM(v, first_word + wide_count, rest, out + wide_count);                 \
+        }                                                                                      \
+    }
+
+#if VM_THREADED_DISPATCH
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+DEFINE_VM_KERNEL(RunVM, u64, 0, )
+DEFINE_REGISTER_KERNEL(RunRegisterVM, u64, 0, )
+
+#if defined(__x86_64__)
+typedef u64 u64x4 __attribute__((vector_size(32)));
+typedef u64 u64x8 __attribute__((vector_size(64)));
+
+DEFINE_VM_KERNEL(RunVM256, u64x4, 2, __attribute__((target("avx2"))))
+DEFINE_VM_KERNEL(RunVM512, u64x8, 3, __attribute__((target("avx512f"))))
+DEFINE_REGISTER_KERNEL(RunRegisterVM256, u64x4, 2, __attribute__((target("avx2"))))
+DEFINE_REGISTER_KERNEL(RunRegisterVM512, u64x8, 3, __attribute__((target("avx512f"))))
+#endif
 
-internal u64
-RunVM(u64 row_idx)
+#if VM_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
+// NOTE(fcasibu): native code first, then the register kernels, the stack kernels are only used
+// for chunks that did not fit the register file
+internal vm_kernel *
+SelectVMKernel(chunk *c)
+{
+    if (c->native)
+        return RunNative;
+
+    b32 registers = c->registers.lowered;
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return registers ? RunRegisterVM512 : RunVM512;
+
+    if (__builtin_cpu_supports("avx2"))
+        return registers ? RunRegisterVM256 : RunVM256;
+#endif
+
+    return registers ? RunRegisterVM : RunVM;
+}
+
+internal void
+InitializeVM(vm *v, memory_arena *arena, chunk *c)
 {
-    chunk *c = VM.chunks;
+    Assert(v);
+    Assert(arena);
     Assert(c);
 
-    u8 *ip = c->items;
-    u8 *end = c->items + c->size;
-    u64 *sp = VM.stack;
-
-    while (ip < end) {
-        u8 opcode = *ip++;
-
-        switch (opcode) {
-            case OP_Var: {
-                u8 var_idx = *ip++;
-
-                u64 val;
-                if (var_idx < 6) {
-                    // a lot of wizardry found here https://graphics.stanford.edu/~seander/bithacks.html
-                    local_const u64 b[] = {
-                        0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
-                        0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
-                    };
-                    val = b[var_idx];
-                } else {
-                    val = ((row_idx >> var_idx) & 1) ? ~(u64)0 : 0;
-                }
-                *sp++ = val;
-            } break;
-
-            case OP_And: {
-                u64 b = *--sp;
-                u64 a = *--sp;
-                *sp++ = a & b;
-            } break;
-            case OP_Or: {
-                u64 b = *--sp;
-                u64 a = *--sp;
-                *sp++ = a | b;
-            } break;
-            case OP_Xor: {
-                u64 b = *--sp;
-                u64 a = *--sp;
-                *sp++ = a ^ b;
-            } break;
-            case OP_Not: {
-                u64 a = *--sp;
-                *sp++ = ~a;
-            } break;
-            case OP_Imply: {
-                u64 b = *--sp;
-                u64 a = *--sp;
-                *sp++ = (~a) | b;
-            } break;
-            case OP_Nand: {
-                u64 b = *--sp;
-                u64 a = *--sp;
-                *sp++ = ~(a & b);
-            } break;
-            case OP_Nor: {
-                u64 b = *--sp;
-                u64 a = *--sp;
-                *sp++ = ~(a | b);
-            } break;
-            case OP_Xnor: {
-                u64 b = *--sp;
-                u64 a = *--sp;
-                *sp++ = ~(a ^ b);
-            } break;
-        }
+    v->chunks = c;
+    v->ip = c->items;
+    v->Kernel = SelectVMKernel(c);
+
+    v->stack_size = (c->slot_count + c->max_depth) * VM_MAX_LANE_WORDS;
+    v->stack = PushSize_(arena, Max(v->stack_size, 1) * sizeof(u64), 64);
+    Assert(v->stack);
+}
+
+internal inline u64
+GetRowWordCount(u64 row_count)
+{
+    return (row_count + 63) / 64;
+}
+
+internal inline void
+EvaluateRowBlock(vm *v, row_block block, u64 *out)
+{
+    TraceBlock("EvaluateRowBlock", "first_word", block.first_word, "words", block.word_count) {
+        v->Kernel(v, block.first_word, block.word_count, out);
     }
+}
+
+internal inline row_block
+GetRowBlock(u64 word_count, u64 block_idx)
+{
+    u64 first_word = block_idx * ROW_BLOCK_WORDS;
+    row_block result = { first_word, Min(ROW_BLOCK_WORDS, word_count - first_word) };
+
+    return result;
+}
+
+typedef struct {
+    vm *vms[MAX_WORKERS];
+    truth_table *table;
+} truth_table_job;
 
-    return *(sp - 1);
+// NOTE(fcasibu): blocks never overlap, so workers write straight into the results
+internal
+WORKER_PROC(EvaluateTruthTableBlock)
+{
+    truth_table_job *job = (truth_table_job *)user;
+    results *r = &job->table->results;
+
+    row_block block = GetRowBlock(r->size, item_idx);
+    EvaluateRowBlock(job->vms[worker_idx], block, r->items + block.first_word);
 }
 
+// NOTE(fcasibu): the columns and row count of c, without results or a BDD
 internal truth_table *
-GetTruthTable(memory_arena *arena)
+PushTruthTable(memory_arena *arena, const chunk *c)
 {
-    chunk *c = VM.chunks;
-    Assert(c && c->vars.size <= 10);
+    Assert(c && c->vars.size <= MAX_VARS);
 
     truth_table *table = PushStruct(arena, typeof(*table));
+    ZeroStruct(table);
     table->vars.size = c->vars.size;
     table->vars.items = PushArray(arena, table->vars.size, typeof(*table->vars.items));
 
     for (usize i = 0; i < table->vars.size; ++i)
         table->vars.items[i] = c->vars.items[i].name;
 
-    table->row_count = 1 << table->vars.size;
+    table->row_count = (u64)1 << table->vars.size;
+    table->root = BDD_FALSE;
+
+    return table;
+}
+
+internal truth_table *
+GetTruthTable(vm *v, memory_arena *arena)
+{
+    chunk *c = v->chunks;
+    truth_table *table = PushTruthTable(arena, c);
+
+    usize word_count = GetRowWordCount(table->row_count);
+    ArrayInit(arena, &table->results, word_count);
+    table->results.size = word_count;
+
+    u64 block_count = (word_count + ROW_BLOCK_WORDS - 1) / ROW_BLOCK_WORDS;
+    usize worker_count = Min(GetWorkerCount(), block_count);
 
-    table->results.size = (table->row_count + 63) / 64;
-    ArrayInit(arena, &table->results, table->results.size);
+    truth_table_job job = { 0 };
+    job.table = table;
+    job.vms[0] = v;
 
-    for (usize i = 0; i < table->row_count; i += 64)
-        table->results.items[i / 64] = RunVM(i);
+    for (usize i = 1; i < worker_count; ++i) {
+        job.vms[i] = PushStruct(arena, vm);
+        InitializeVM(job.vms[i], arena, c);
+    }
+
+    work_queue *queue = PushStruct(arena, work_queue);
+    RunWorkQueue(queue, block_count, worker_count, EvaluateTruthTableBlock, &job);
 
     return table;
 }
 
+internal inline b32
+IsTruthTableDense(const truth_table *table)
+{
+    return table->results.size > 0;
+}
+
+// NOTE(fcasibu): a dense table hands out its own words, one that is only a BDD derives them into
+// out
+maybe_unused internal const u64 *
+GetTruthWords(const truth_table *table, u64 first_word, usize word_count, u64 *out)
+{
+    Assert(first_word + word_count <= GetRowWordCount(table->row_count));
+
+    if (IsTruthTableDense(table))
+        return table->results.items + first_word;
+
+    Assert(table->bdd);
+    GetBddTruthWords(table->bdd, table->root, first_word, word_count, out);
+
+    return out;
+}
+
+internal u8
+GetTruthValue(const truth_table *table, u64 row_idx)
+{
+    Assert(row_idx < table->row_count);
+
+    u64 chunk = IsTruthTableDense(table) ? table->results.items[row_idx / 64]
+                                         : GetBddTruthWord(table->bdd, table->root, row_idx / 64);
+    return (u8)((chunk >> (row_idx % 64)) & 1);
+}
+
+// NOTE(fcasibu): counted on the BDD when there is one, it never has to look at every row
+maybe_unused internal u64
+GetTrueRowCount(const truth_table *table)
+{
+    if (table->bdd)
+        return GetBddSatCount(table->bdd, table->root);
+
+    // NOTE(fcasibu): tables under 64 rows repeat their rows through the rest of the word
+    if (table->row_count < 64)
+        return __builtin_popcountll(table->results.items[0] & (((u64)1 << table->row_count) - 1));
+
+    u64 result = 0;
+    for (usize i = 0; i < table->results.size; ++i)
+        result += __builtin_popcountll(table->results.items[i]);
+
+    return result;
+}
+
 internal inline b32
 TryMergeImplicants(implicant a, implicant b, implicant *out)
 {
     if (a.mask != b.mask)
         return false;
 
-    u16 diff = a.value ^ b.value;
+    u32 diff = a.value ^ b.value;
 
     if (diff && ((diff & (diff - 1)) == 0)) {
         out->value = a.value & ~diff;
@@ -119,11 +521,523 @@ TryMergeImplicants(implicant a, implicant b, implicant *out)
 }
 
 internal inline b32
-ImplicantCovers(implicant imp, u16 minterm)
+ImplicantCovers(implicant imp, u32 minterm)
 {
     return (minterm & ~imp.mask) == imp.value;
 }
 
+// NOTE(fcasibu): exact minimization is exponential, wider tables go to MinimizeHeuristic. The
+// dedupe keys below pack value and mask into 16 bits each.
+#define QM_MAX_VARS 16
+
+// NOTE(fcasibu): open-addressing map from a u32 key to a u32 value, value 0 marks an empty cell
+typedef struct {
+    u32 *keys;
+    u32 *values;
+    usize capacity;
+    usize count;
+} implicant_table;
+
+internal void
+InitializeImplicantTable(memory_arena *arena, implicant_table *t, usize expected)
+{
+    usize capacity = 16;
+    while (capacity < expected * 2)
+        capacity *= 2;
+
+    t->keys = PushArray(arena, capacity, u32);
+    t->values = PushArray(arena, capacity, u32);
+    Assert(t->keys && t->values);
+    ZeroArray(capacity, t->values);
+
+    t->capacity = capacity;
+    t->count = 0;
+}
+
+internal inline u32 *
+FindImplicantTableCell(implicant_table *t, u32 key)
+{
+    usize mask = t->capacity - 1;
+    usize at = (key * 0x9E3779B1u) & mask;
+
+    while (t->values[at] && t->keys[at] != key)
+        at = (at + 1) & mask;
+
+    t->keys[at] = key;
+    return &t->values[at];
+}
+
+internal void
+PutImplicantTable(memory_arena *arena, implicant_table *t, u32 key, u32 value)
+{
+    Assert(value);
+
+    u32 *cell = FindImplicantTableCell(t, key);
+    if (!*cell)
+        t->count += 1;
+    *cell = value;
+
+    if (t->count * 2 > t->capacity) {
+        implicant_table grown = { 0 };
+        InitializeImplicantTable(arena, &grown, t->count * 2);
+
+        for (usize i = 0; i < t->capacity; ++i) {
+            if (t->values[i]) {
+                *FindImplicantTableCell(&grown, t->keys[i]) = t->values[i];
+                grown.count += 1;
+            }
+        }
+
+        *t = grown;
+    }
+}
+
+internal inline u32
+GetImplicantTable(implicant_table *t, u32 key)
+{
+    usize mask = t->capacity - 1;
+    usize at = (key * 0x9E3779B1u) & mask;
+
+    while (t->values[at]) {
+        if (t->keys[at] == key)
+            return t->values[at];
+        at = (at + 1) & mask;
+    }
+
+    return 0;
+}
+
+// NOTE(fcasibu): two implicants can only merge when they share a mask and their popcounts are one
+// apart
+internal inline u32
+GetImplicantGroup(u32 mask, u32 popcount)
+{
+    return ((u32)mask << 5) | popcount;
+}
+
+internal inline b32
+IsBitSet(const u64 *bits, usize idx)
+{
+    return (bits[idx / 64] >> (idx % 64)) & 1;
+}
+
+internal inline void
+SetBit(u64 *bits, usize idx)
+{
+    bits[idx / 64] |= (u64)1 << (idx % 64);
+}
+
+internal inline void
+ClearBit(u64 *bits, usize idx)
+{
+    bits[idx / 64] &= ~((u64)1 << (idx % 64));
+}
+
+// NOTE(fcasibu): cyclic cores that need more search nodes than this keep the best cover found so
+// far, which starts out as the greedy one
+#define QM_COVER_MAX_NODES (1 << 20)
+
+// NOTE(fcasibu): prime implicant chart over the minterms the essentials left uncovered. rows[p]
+// is the set of minterms prime p covers, columns[m] the set of primes covering minterm m.
+typedef struct {
+    usize prime_count;
+    usize minterm_count;
+    usize minterm_words;
+    usize prime_words;
+
+    u64 *rows;
+    u64 *columns;
+    u32 *literals;
+
+    u64 *alive_primes;
+    u64 *alive_minterms;
+
+    u64 *levels;
+    u64 *scratch;
+    usize *chosen;
+    usize chosen_count;
+    usize chosen_literals;
+
+    usize *best;
+    usize best_count;
+    usize best_literals;
+    usize nodes;
+} prime_chart;
+
+internal inline u64 *
+GetChartRow(prime_chart *chart, usize prime)
+{
+    return chart->rows + prime * chart->minterm_words;
+}
+
+internal inline u64 *
+GetChartColumn(prime_chart *chart, usize minterm)
+{
+    return chart->columns + minterm * chart->prime_words;
+}
+
+internal void
+KillChartPrime(prime_chart *chart, usize prime)
+{
+    ClearBit(chart->alive_primes, prime);
+}
+
+// NOTE(fcasibu): takes the prime into the cover and drops every minterm it covers
+internal void
+SelectChartPrime(prime_chart *chart, usize prime)
+{
+    u64 *row = GetChartRow(chart, prime);
+    for (usize w = 0; w < chart->minterm_words; ++w)
+        chart->alive_minterms[w] &= ~row[w];
+
+    KillChartPrime(chart, prime);
+    chart->chosen[chart->chosen_count++] = prime;
+    chart->chosen_literals += chart->literals[prime];
+}
+
+// NOTE(fcasibu): essentials of the reduced chart, then a prime whose minterms another prime
+// covers at no more literals goes, then a minterm whose primes all cover another minterm goes,
+// until nothing changes
+internal void
+ReduceChart(prime_chart *chart)
+{
+    b32 changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (usize m = 0; m < chart->minterm_count; ++m) {
+            if (!IsBitSet(chart->alive_minterms, m))
+                continue;
+
+            u64 *column = GetChartColumn(chart, m);
+            usize count = 0;
+            usize last = 0;
+            for (usize w = 0; w < chart->prime_words; ++w) {
+                u64 live = column[w] & chart->alive_primes[w];
+                if (live) {
+                    count += __builtin_popcountll(live);
+                    last = w * 64 + (63 - __builtin_clzll(live));
+                }
+            }
+
+            if (count == 1) {
+                SelectChartPrime(chart, last);
+                changed = true;
+            }
+        }
+
+        for (usize p = 0; p < chart->prime_count; ++p) {
+            if (!IsBitSet(chart->alive_primes, p))
+                continue;
+
+            u64 *row = GetChartRow(chart, p);
+            b32 empty = true;
+            for (usize w = 0; w < chart->minterm_words && empty; ++w)
+                empty = !(row[w] & chart->alive_minterms[w]);
+
+            for (usize q = 0; q < chart->prime_count && !empty; ++q) {
+                if (q == p || !IsBitSet(chart->alive_primes, q) ||
+                    chart->literals[q] > chart->literals[p])
+                    continue;
+
+                u64 *other = GetChartRow(chart, q);
+                b32 subset = true;
+                b32 equal = true;
+                for (usize w = 0; w < chart->minterm_words && subset; ++w) {
+                    u64 mine = row[w] & chart->alive_minterms[w];
+                    u64 theirs = other[w] & chart->alive_minterms[w];
+                    subset = !(mine & ~theirs);
+                    equal = equal && mine == theirs;
+                }
+
+                // NOTE(fcasibu): of two identical primes with the same cost the later one goes
+                if (subset && (!equal || chart->literals[q] < chart->literals[p] || q < p)) {
+                    empty = true;
+                    break;
+                }
+            }
+
+            if (empty) {
+                KillChartPrime(chart, p);
+                changed = true;
+            }
+        }
+
+        for (usize a = 0; a < chart->minterm_count; ++a) {
+            if (!IsBitSet(chart->alive_minterms, a))
+                continue;
+
+            u64 *column = GetChartColumn(chart, a);
+
+            for (usize b = 0; b < chart->minterm_count; ++b) {
+                if (b == a || !IsBitSet(chart->alive_minterms, b))
+                    continue;
+
+                u64 *other = GetChartColumn(chart, b);
+                b32 subset = true;
+                b32 equal = true;
+                for (usize w = 0; w < chart->prime_words && subset; ++w) {
+                    u64 mine = column[w] & chart->alive_primes[w];
+                    u64 theirs = other[w] & chart->alive_primes[w];
+                    subset = !(mine & ~theirs);
+                    equal = equal && mine == theirs;
+                }
+
+                // NOTE(fcasibu): covering a covers b, so b no longer constrains anything
+                if (subset && (!equal || a < b)) {
+                    ClearBit(chart->alive_minterms, b);
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+// NOTE(fcasibu): minterms that share no prime each need a prime of their own
+internal usize
+GetCoverLowerBound(prime_chart *chart, const u64 *uncovered)
+{
+    u64 *used = chart->scratch;
+    ZeroArray(chart->prime_words, used);
+    usize result = 0;
+
+    for (usize m = 0; m < chart->minterm_count; ++m) {
+        if (!IsBitSet(uncovered, m))
+            continue;
+
+        u64 *column = GetChartColumn(chart, m);
+        b32 independent = true;
+        for (usize w = 0; w < chart->prime_words && independent; ++w)
+            independent = !(column[w] & chart->alive_primes[w] & used[w]);
+
+        if (independent) {
+            for (usize w = 0; w < chart->prime_words; ++w)
+                used[w] |= column[w] & chart->alive_primes[w];
+            result += 1;
+        }
+    }
+
+    return result;
+}
+
+internal void
+SearchMinimumCover(prime_chart *chart, usize depth)
+{
+    if (chart->nodes++ >= QM_COVER_MAX_NODES)
+        return;
+
+    u64 *uncovered = chart->levels + depth * chart->minterm_words;
+
+    usize branch = chart->minterm_count;
+    usize branch_count = 0;
+
+    for (usize m = 0; m < chart->minterm_count; ++m) {
+        if (!IsBitSet(uncovered, m))
+            continue;
+
+        u64 *column = GetChartColumn(chart, m);
+        usize count = 0;
+        for (usize w = 0; w < chart->prime_words; ++w)
+            count += __builtin_popcountll(column[w] & chart->alive_primes[w]);
+
+        if (branch == chart->minterm_count || count < branch_count) {
+            branch = m;
+            branch_count = count;
+        }
+    }
+
+    if (branch == chart->minterm_count) {
+        if (chart->chosen_count < chart->best_count ||
+            (chart->chosen_count == chart->best_count &&
+             chart->chosen_literals < chart->best_literals)) {
+            memcpy(chart->best, chart->chosen, chart->chosen_count * sizeof(*chart->best));
+            chart->best_count = chart->chosen_count;
+            chart->best_literals = chart->chosen_literals;
+        }
+        return;
+    }
+
+    usize bound = chart->chosen_count + GetCoverLowerBound(chart, uncovered);
+    if (bound > chart->best_count ||
+        (bound == chart->best_count && chart->chosen_literals >= chart->best_literals))
+        return;
+
+    u64 *column = GetChartColumn(chart, branch);
+    u64 *next = uncovered + chart->minterm_words;
+
+    for (usize p = 0; p < chart->prime_count; ++p) {
+        if (!IsBitSet(column, p) || !IsBitSet(chart->alive_primes, p))
+            continue;
+
+        u64 *row = GetChartRow(chart, p);
+        for (usize w = 0; w < chart->minterm_words; ++w)
+            next[w] = uncovered[w] & ~row[w];
+
+        chart->chosen[chart->chosen_count++] = p;
+        chart->chosen_literals += chart->literals[p];
+
+        SearchMinimumCover(chart, depth + 1);
+
+        chart->chosen_count -= 1;
+        chart->chosen_literals -= chart->literals[p];
+    }
+}
+
+// NOTE(fcasibu): essential primes first, in the order their minterms show up, then chart
+// reduction and branch-and-bound over whatever cyclic core is left
+internal implicants *
+FindMinimumCover(memory_arena *arena, const truth_table *table, implicants *primes)
+{
+    implicants *result = PushStruct(arena, typeof(*result));
+    ArrayInit(arena, result, Max(primes->size, 1));
+
+    for (usize j = 0; j < primes->size; ++j)
+        primes->items[j].used = false;
+
+    usize minterm_count = 0;
+    for (usize i = 0; i < table->row_count; ++i)
+        minterm_count += GetTruthValue(table, i);
+
+    u32 *minterms = PushArray(arena, Max(minterm_count, 1), u32);
+    minterm_count = 0;
+
+    for (usize i = 0; i < table->row_count; ++i) {
+        if (!GetTruthValue(table, i))
+            continue;
+
+        u32 minterm = (u32)i;
+        minterms[minterm_count++] = minterm;
+
+        usize cover_count = 0;
+        usize last_idx = 0;
+
+        for (usize j = 0; j < primes->size; ++j) {
+            if (ImplicantCovers(primes->items[j], minterm)) {
+                cover_count++;
+                last_idx = j;
+            }
+        }
+
+        if (cover_count == 1 && !primes->items[last_idx].used) {
+            primes->items[last_idx].used = true;
+            ArrayPush(arena, result, primes->items[last_idx]);
+        }
+    }
+
+    usize remaining = 0;
+    for (usize i = 0; i < minterm_count; ++i) {
+        b32 covered = false;
+        for (usize j = 0; j < result->size && !covered; ++j)
+            covered = ImplicantCovers(result->items[j], minterms[i]);
+
+        if (!covered)
+            minterms[remaining++] = minterms[i];
+    }
+
+    if (remaining == 0)
+        return result;
+
+    prime_chart chart = { 0 };
+    chart.prime_count = primes->size;
+    chart.minterm_count = remaining;
+    chart.minterm_words = (remaining + 63) / 64;
+    chart.prime_words = (primes->size + 63) / 64;
+
+    chart.rows = PushArray(arena, chart.prime_count * chart.minterm_words, u64);
+    chart.columns = PushArray(arena, chart.minterm_count * chart.prime_words, u64);
+    chart.literals = PushArray(arena, chart.prime_count, u32);
+    chart.alive_primes = PushArray(arena, chart.prime_words, u64);
+    chart.alive_minterms = PushArray(arena, chart.minterm_words, u64);
+    chart.levels = PushArray(arena, (chart.prime_count + 1) * chart.minterm_words, u64);
+    chart.scratch = PushArray(arena, chart.prime_words, u64);
+    chart.chosen = PushArray(arena, chart.prime_count, usize);
+    chart.best = PushArray(arena, chart.prime_count, usize);
+
+    ZeroArray(chart.prime_count * chart.minterm_words, chart.rows);
+    ZeroArray(chart.minterm_count * chart.prime_words, chart.columns);
+    ZeroArray(chart.prime_words, chart.alive_primes);
+    ZeroArray(chart.minterm_words, chart.alive_minterms);
+
+    u32 all_mask = (u32)(((u64)1 << table->vars.size) - 1);
+
+    for (usize p = 0; p < chart.prime_count; ++p) {
+        chart.literals[p] = __builtin_popcount(~primes->items[p].mask & all_mask);
+        if (primes->items[p].used)
+            continue;
+
+        for (usize m = 0; m < chart.minterm_count; ++m) {
+            if (ImplicantCovers(primes->items[p], minterms[m])) {
+                SetBit(GetChartRow(&chart, p), m);
+                SetBit(GetChartColumn(&chart, m), p);
+                SetBit(chart.alive_primes, p);
+            }
+        }
+    }
+
+    for (usize m = 0; m < chart.minterm_count; ++m)
+        SetBit(chart.alive_minterms, m);
+
+    ReduceChart(&chart);
+
+    usize forced = chart.chosen_count;
+    usize forced_literals = chart.chosen_literals;
+
+    // NOTE(fcasibu): greedy cover as the first bound, most newly covered minterms per step
+    u64 *uncovered = chart.levels;
+    memcpy(uncovered, chart.alive_minterms, chart.minterm_words * sizeof(u64));
+    memcpy(chart.best, chart.chosen, forced * sizeof(usize));
+    chart.best_count = forced;
+    chart.best_literals = forced_literals;
+
+    for (;;) {
+        usize pick = chart.prime_count;
+        usize pick_gain = 0;
+
+        for (usize p = 0; p < chart.prime_count; ++p) {
+            if (!IsBitSet(chart.alive_primes, p))
+                continue;
+
+            u64 *row = GetChartRow(&chart, p);
+            usize gain = 0;
+            for (usize w = 0; w < chart.minterm_words; ++w)
+                gain += __builtin_popcountll(row[w] & uncovered[w]);
+
+            if (gain > pick_gain) {
+                pick = p;
+                pick_gain = gain;
+            }
+        }
+
+        if (pick == chart.prime_count)
+            break;
+
+        u64 *row = GetChartRow(&chart, pick);
+        for (usize w = 0; w < chart.minterm_words; ++w)
+            uncovered[w] &= ~row[w];
+
+        chart.best[chart.best_count++] = pick;
+        chart.best_literals += chart.literals[pick];
+    }
+
+    memcpy(chart.levels, chart.alive_minterms, chart.minterm_words * sizeof(u64));
+    SearchMinimumCover(&chart, 0);
+
+    // NOTE(fcasibu): core primes go out in prime order so the result does not depend on the
+    // search order
+    for (usize p = 0; p < chart.prime_count; ++p) {
+        for (usize k = 0; k < chart.best_count; ++k) {
+            if (chart.best[k] == p) {
+                primes->items[p].used = true;
+                ArrayPush(arena, result, primes->items[p]);
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
 // https://en.wikipedia.org/wiki/Quine%E2%80%93McCluskey_algorithm
 internal implicants *
 FindPrimeImplicants(memory_arena *arena, const truth_table *table)
@@ -135,7 +1049,7 @@ FindPrimeImplicants(memory_arena *arena, const truth_table *table)
 
     for (usize i = 0; i < table->row_count; ++i) {
         if (GetTruthValue(table, i)) {
-            implicant imp = { .value = (u16)i, .mask = 0, .used = false };
+            implicant imp = { .value = (u32)i, .mask = 0, .used = false };
             ArrayPush(arena, &current, imp);
         }
     }
@@ -143,30 +1057,59 @@ FindPrimeImplicants(memory_arena *arena, const truth_table *table)
     implicants primes = { 0 };
     ArrayInit(arena, &primes, current.size);
 
-    while (current.size > 0) {
+    for (usize round = 0; current.size > 0; ++round) {
+        trace_span span = BeginTraceSpan("MergeImplicants", "round", round, "implicants",
+                                         current.size);
+
         implicants next = { 0 };
         ArrayInit(arena, &next, current.size);
         b32 merged_any = false;
 
+        // NOTE(fcasibu): groups are singly linked lists in ascending index order, the table
+        // holds head index + 1
+        u32 *next_in_group = PushArray(arena, current.size, u32);
+        implicant_table groups = { 0 };
+        InitializeImplicantTable(arena, &groups, current.size);
+
+        for (usize i = current.size; i > 0; --i) {
+            implicant imp = current.items[i - 1];
+            u32 group = GetImplicantGroup(imp.mask, __builtin_popcount(imp.value));
+
+            next_in_group[i - 1] = GetImplicantTable(&groups, group);
+            PutImplicantTable(arena, &groups, group, (u32)i);
+        }
+
+        implicant_table seen = { 0 };
+        InitializeImplicantTable(arena, &seen, current.size);
+
+        // NOTE(fcasibu): candidates from the groups above and below are walked in index order so
+        // merges come out in the same order as comparing every pair
         for (usize i = 0; i < current.size; ++i) {
-            for (usize j = i + 1; j < current.size; ++j) {
+            implicant imp = current.items[i];
+            u32 popcount = __builtin_popcount(imp.value);
+
+            u32 above = GetImplicantTable(&groups, GetImplicantGroup(imp.mask, popcount + 1));
+            u32 below = popcount ? GetImplicantTable(&groups,
+                                                     GetImplicantGroup(imp.mask, popcount - 1))
+                                 : 0;
+
+            while (above || below) {
+                u32 *from = (above && (!below || above < below)) ? &above : &below;
+                usize j = *from - 1;
+                *from = next_in_group[j];
+
                 implicant merged;
+                if (j <= i || !TryMergeImplicants(current.items[i], current.items[j], &merged))
+                    continue;
 
-                if (TryMergeImplicants(current.items[i], current.items[j], &merged)) {
-                    current.items[i].used = true;
-                    current.items[j].used = true;
-                    merged_any = true;
-
-                    b32 exists = false;
-                    for (usize k = 0; k < next.size; ++k) {
-                        if (next.items[k].value == merged.value &&
-                            next.items[k].mask == merged.mask) {
-                            exists = true;
-                            break;
-                        }
-                    }
-                    if (!exists)
-                        ArrayPush(arena, &next, merged);
+                current.items[i].used = true;
+                current.items[j].used = true;
+                merged_any = true;
+
+                u32 key = ((u32)merged.value << 16) | merged.mask;
+                if (!GetImplicantTable(&seen, key)) {
+                    PutImplicantTable(arena, &seen, key, 1);
+                    ArrayPush(arena, &next, merged);
                 }
             }
         }
@@ -176,60 +1119,45 @@ FindPrimeImplicants(memory_arena *arena, const truth_table *table)
                 ArrayPush(arena, &primes, current.items[i]);
         }
 
+        EndTraceSpan(&span);
+
         current = next;
         if (!merged_any)
             break;
     }
 
-    implicants *essentials = PushStruct(arena, typeof(*essentials));
-    ArrayInit(arena, essentials, primes.size);
-
-    for (usize i = 0; i < table->row_count; ++i) {
-        if (!GetTruthValue(table, i))
-            continue;
-
-        u16 minterm = (u16)i;
-        usize cover_count = 0;
-        usize last_idx = 0;
-
-        for (usize j = 0; j < primes.size; ++j) {
-            if (ImplicantCovers(primes.items[j], minterm)) {
-                cover_count++;
-                last_idx = j;
-            }
-        }
-
-        if (cover_count == 1 && !primes.items[last_idx].used) {
-            primes.items[last_idx].used = true;
-            ArrayPush(arena, essentials, primes.items[last_idx]);
-        }
-    }
+    return FindMinimumCover(arena, table, &primes);
+}
 
-    if (essentials->size == 0 && primes.size > 0) {
-        for (usize i = 0; i < primes.size; ++i)
-            ArrayPush(arena, essentials, primes.items[i]);
-    }
+// NOTE(fcasibu): room for every variable as "NOT name AND "
+internal usize
+GetTermCapacity(const truth_table *table)
+{
+    usize result = 1;
+    for (usize i = 0; i < table->vars.size; ++i)
+        result += strlen(table->vars.items[i]) + sizeof("NOT  AND ");
 
-    return essentials;
+    return result;
 }
 
 internal const char *
 FormatImplicant(memory_arena *arena, const truth_table *table, implicant imp)
 {
-    char *result = PushSize(arena, 256);
+    usize capacity = GetTermCapacity(table);
+    char *result = PushSize(arena, capacity);
     usize pos = 0;
     b32 first = true;
 
     for (usize i = 0; i < table->vars.size; ++i) {
         if (!((imp.mask >> i) & 1)) {
             if (!first)
-                pos += snprintf(result + pos, 256 - pos, " AND ");
+                pos += snprintf(result + pos, capacity - pos, " AND ");
 
             first = false;
             if (!((imp.value >> i) & 1))
-                pos += snprintf(result + pos, 256 - pos, "NOT ");
+                pos += snprintf(result + pos, capacity - pos, "NOT ");
 
-            pos += snprintf(result + pos, 256 - pos, "%s", table->vars.items[i]);
+            pos += snprintf(result + pos, capacity - pos, "%s", table->vars.items[i]);
         }
     }
 
@@ -242,8 +1170,8 @@ TrySimplifyGate(memory_arena *arena, const truth_table *table, const implicants
     Assert(table);
     Assert(imps);
 
-    u16 active_vars_mask = 0;
-    u16 all_mask = (1 << table->vars.size) - 1;
+    u32 active_vars_mask = 0;
+    u32 all_mask = (u32)(((u64)1 << table->vars.size) - 1);
 
     for (usize i = 0; i < imps->size; ++i)
         active_vars_mask |= (~imps->items[i].mask) & all_mask;
@@ -263,8 +1191,8 @@ TrySimplifyGate(memory_arena *arena, const truth_table *table, const implicants
 
     u8 sig = 0;
     for (usize i = 0; i < 4; ++i) {
-        u16 a = (i >> 0) & 1;
-        u16 b = (i >> 1) & 1;
+        u32 a = (i >> 0) & 1;
+        u32 b = (i >> 1) & 1;
 
         for (usize k = 0; k < imps->size; ++k) {
             implicant imp = imps->items[k];
@@ -316,11 +1244,18 @@ TrySimplifyGate(memory_arena *arena, const truth_table *table, const implicants
 
 // TODO(fcasibu): odd number of signals
 internal const char *
-SimplifyExpression(memory_arena *arena, const truth_table *table)
+SimplifyExpression(memory_arena *arena, const truth_table *table, minimizer method)
 {
     Assert(table);
 
-    implicants *essentials = FindPrimeImplicants(arena, table);
+    if (method == Minimizer_Auto)
+        method = table->vars.size > QM_MAX_VARS ? Minimizer_Heuristic : Minimizer_Exact;
+
+    if (method == Minimizer_Exact && table->vars.size > QM_MAX_VARS)
+        return NULL;
+
+    implicants *essentials = method == Minimizer_Exact ? FindPrimeImplicants(arena, table)
+                                                       : MinimizeHeuristic(arena, table);
     Assert(essentials);
 
     if (essentials->size == 0) {
@@ -329,7 +1264,7 @@ SimplifyExpression(memory_arena *arena, const truth_table *table)
         return result;
     }
 
-    u16 all_mask = (1 << table->vars.size) - 1;
+    u32 all_mask = (u32)(((u64)1 << table->vars.size) - 1);
     if (essentials->size == 1 && essentials->items[0].mask == all_mask) {
         char *result = PushSize(arena, 2048);
         snprintf(result, 2048, "%s OR NOT %s", table->vars.items[0], table->vars.items[0]);
@@ -340,17 +1275,17 @@ SimplifyExpression(memory_arena *arena, const truth_table *table)
     if (simple)
         return simple;
 
-    u16 common_mask = all_mask;
-    u16 common_value = 0;
+    u32 common_mask = all_mask;
+    u32 common_value = 0;
 
     for (usize i = 0; i < essentials->size; ++i) {
-        u16 fixed_bits = ~essentials->items[i].mask & all_mask;
+        u32 fixed_bits = ~essentials->items[i].mask & all_mask;
         if (i == 0) {
             common_mask = fixed_bits;
             common_value = essentials->items[i].value & fixed_bits;
         } else {
-            u16 both_fixed = common_mask & fixed_bits;
-            u16 same_vals = ~(common_value ^ essentials->items[i].value);
+            u32 both_fixed = common_mask & fixed_bits;
+            u32 same_vals = ~(common_value ^ essentials->items[i].value);
             common_mask = both_fixed & same_vals;
             common_value &= common_mask;
         }
@@ -370,63 +1305,158 @@ SimplifyExpression(memory_arena *arena, const truth_table *table)
         const char *inner = TrySimplifyGate(arena, table, &reduced);
 
         if (inner) {
-            char *factor = PushSize(arena, 1024);
-            usize fpos = 0;
-            b32 first = true;
-
-            for (usize i = 0; i < table->vars.size; ++i) {
-                if ((common_mask >> i) & 1) {
-                    if (!first)
-                        fpos += snprintf(factor + fpos, 1024 - fpos, " AND ");
-                    first = false;
-
-                    if (!((common_value >> i) & 1))
-                        fpos += snprintf(factor + fpos, 1024 - fpos, "NOT ");
+            implicant common = { .value = common_value, .mask = ~common_mask };
+            const char *factor = FormatImplicant(arena, table, common);
 
-                    fpos += snprintf(factor + fpos, 1024 - fpos, "%s", table->vars.items[i]);
-                }
-            }
-
-            char *result = PushSize(arena, 2048);
-            snprintf(result, 2048, "(%s) AND (%s)", inner, factor);
+            usize capacity = strlen(inner) + strlen(factor) + sizeof("() AND ()");
+            char *result = PushSize(arena, capacity);
+            snprintf(result, capacity, "(%s) AND (%s)", inner, factor);
             return result;
         }
     }
 
-    char *result = PushSize(arena, 2048);
+    usize capacity = essentials->size * (GetTermCapacity(table) + sizeof("() OR "));
+    char *result = PushSize(arena, capacity);
     usize pos = 0;
 
     for (usize i = 0; i < essentials->size; ++i) {
         if (i > 0)
-            pos += snprintf(result + pos, 2048 - pos, " OR ");
+            pos += snprintf(result + pos, capacity - pos, " OR ");
 
         const char *term = FormatImplicant(arena, table, essentials->items[i]);
 
         if (essentials->size > 1 && strstr(term, " AND ")) {
-            pos += snprintf(result + pos, 2048 - pos, "(%s)", term);
+            pos += snprintf(result + pos, capacity - pos, "(%s)", term);
         } else {
-            pos += snprintf(result + pos, 2048 - pos, "%s", term);
+            pos += snprintf(result + pos, capacity - pos, "%s", term);
         }
     }
 
     return result;
 }
 
-internal eval_result
-Interpret(memory_arena *arena, const char *source)
+internal engine *
+CreateEngine(memory_arena *arena)
+{
+    Assert(arena);
+
+    engine *e = PushStruct(arena, engine);
+    Assert(e);
+    ZeroStruct(e);
+
+    return e;
+}
+
+maybe_unused internal void
+ReleaseEngine(engine *e)
 {
+    Assert(e);
+
+    if (e->jit.base)
+        Platform.DeallocateMemory(e->jit.base, e->jit.capacity);
+
+    ZeroStruct(&e->jit);
+}
+
+// NOTE(fcasibu): the front end, only touches the engine's parser and intern pool
+internal b32
+CompileExpression(engine *e, memory_arena *arena, const char *source, column_order columns,
+                  compiled_expression *out)
+{
+    Assert(e);
     Assert(source);
+    Assert(out);
+
+    chunk *c = &out->chunk;
+    ZeroStruct(c);
+    InitializeChunk(arena, c, 2048);
+    InitializeStringInternPool(&e->strings, arena, 10);
 
-    chunk c = { 0 };
-    InitializeChunk(arena, &c, 2048);
-    InitializeStringInternPool(arena, 10);
+    e->parser.strings = &e->strings;
+
+    b32 parsed = false;
+    ProfileBlock(e->profiler, Phase_Parse) {
+        parsed = Parse(&e->parser, arena, c, source);
+    }
 
-    VM.stack_top = VM.stack;
-    VM.chunks = &c;
-    VM.ip = VM.chunks->items;
+    if (!parsed)
+        return false;
+
+    ProfileBlock(e->profiler, Phase_Optimize) {
+        OptimizeChunk(arena, c);
+    }
+
+    // NOTE(fcasibu): only the sifted order needs the BDD up front, the heuristic minimizer builds
+    // its own from the chunk when it runs
+    out->bdd = NULL;
+    out->root = BDD_FALSE;
+    if (columns == Columns_Sifted) {
+        ProfileBlock(e->profiler, Phase_Bdd) {
+            out->bdd = BuildSiftedBdd(arena, c, &out->root);
+            ApplyBddOrder(out->bdd, c);
+        }
+    }
+
+    ProfileBlock(e->profiler, Phase_Lower) {
+        LowerToRegisters(arena, c);
+    }
+
+    return true;
+}
+
+// NOTE(fcasibu): the back end, owns the engine's JIT buffer and VM
+internal truth_table *
+EvaluateExpression(engine *e, memory_arena *arena, compiled_expression *expr)
+{
+    Assert(e);
+    Assert(expr);
+
+    // NOTE(fcasibu): past DENSE_TABLE_MAX_VARS the BDD stands in for the table, the VM only runs
+    // when the BDD outgrew BDD_MAX_NODES
+    b32 wide = expr->chunk.vars.size > DENSE_TABLE_MAX_VARS;
+    if (wide && !expr->bdd) {
+        ProfileBlock(e->profiler, Phase_Bdd) {
+            expr->bdd = BuildSiftedBdd(arena, &expr->chunk, &expr->root);
+        }
+    }
+
+    if (wide && !expr->bdd->overflowed) {
+        truth_table *table = PushTruthTable(arena, &expr->chunk);
+        table->bdd = expr->bdd;
+        table->root = expr->root;
+
+        return table;
+    }
+
+    ProfileBlock(e->profiler, Phase_Jit) {
+        expr->chunk.native = CompileNative(&e->jit, &expr->chunk);
+    }
+
+    InitializeVM(&e->vm, arena, &expr->chunk);
+
+    truth_table *table = NULL;
+    ProfileBlock(e->profiler, Phase_Evaluate) {
+        table = GetTruthTable(&e->vm, arena);
+    }
+
+    AddProfileRows(e->profiler, table->row_count);
+    if (!expr->bdd)
+        table->chunk = &expr->chunk;
+    else if (!expr->bdd->overflowed) {
+        table->bdd = expr->bdd;
+        table->root = expr->root;
+    }
+
+    return table;
+}
+
+maybe_unused internal eval_result
+Interpret(engine *e, memory_arena *arena, const char *source, column_order columns)
+{
+    compiled_expression *expr = PushStruct(arena, compiled_expression);
 
-    if (!Parse(arena, &c, source))
+    if (!CompileExpression(e, arena, source, columns, expr))
         return (eval_result){ Eval_ParseError, { NULL } };
 
-    return (eval_result){ Eval_Ok, { GetTruthTable(arena) } };
+    return (eval_result){ Eval_Ok, { EvaluateExpression(e, arena, expr) } };
 }
@@ -1,6 +1,13 @@
 #ifndef VM_H
 #define VM_H
 
+// NOTE(fcasibu): computed goto dispatch for the stack and register kernels, clang and gcc only
+#if defined(__GNUC__) && !defined(DISABLE_THREADED_DISPATCH)
+#define VM_THREADED_DISPATCH 1
+#else
+#define VM_THREADED_DISPATCH 0
+#endif
+
 typedef struct {
     const char **items;
     usize size;
@@ -15,11 +22,30 @@ typedef struct {
 
 typedef struct {
     references vars;
+
+    // NOTE(fcasibu): empty when the table is only a BDD, GetTruthWord derives the words then
     results results;
 
-    usize row_count;
+    u64 row_count;
+
+    // NOTE(fcasibu): the same function as a BDD, NULL when it outgrew BDD_MAX_NODES or was never
+    // built. Without one, chunk is the code the heuristic minimizer can build it from
+    bdd_manager *bdd;
+    bdd_ref root;
+    const chunk *chunk;
 } truth_table;
 
+// NOTE(fcasibu): a word holds 64 rows, tables are evaluated a block of words at a time
+#define ROW_BLOCK_WORDS KB(1)
+
+// NOTE(fcasibu): wider tables are not materialized while their BDD fits in BDD_MAX_NODES
+#define DENSE_TABLE_MAX_VARS 24
+
+typedef struct {
+    u64 first_word;
+    usize word_count;
+} row_block;
+
 typedef Enum(u8, eval_type){
     Eval_None,
     Eval_Ok,
@@ -33,19 +59,74 @@ typedef struct {
     } value;
 } eval_result;
 
-#define STACK_MAX MB(1)
+// a lot of wizardry found here https://graphics.stanford.edu/~seander/bithacks.html
+global_const u64 VAR_PATTERNS[] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
 
-typedef struct {
+// NOTE(fcasibu): words in the widest lane any stack kernel uses, the stack is sized for it
+#define VM_MAX_LANE_WORDS 8
+
+typedef struct vm vm;
+
+// NOTE(fcasibu): evaluates word_count words (64 rows each) starting at first_word
+#define VM_KERNEL(name) void name(vm *v, u64 first_word, usize word_count, u64 *out)
+typedef VM_KERNEL(vm_kernel);
+
+struct vm {
     chunk *chunks;
     u8 *ip;
+    vm_kernel *Kernel;
 
-    u64 stack[STACK_MAX];
-    u64 *stack_top;
-} vm;
+    // NOTE(fcasibu): slots then the stack, slot_count + max_depth lanes of VM_MAX_LANE_WORDS words
+    // each. Comes from the arena per chunk and is aligned so the wide kernels can use it as a
+    // stack of vectors.
+    u64 *stack;
+    usize stack_size;
+};
 
+// NOTE(fcasibu): a parsed, optimized and lowered expression, everything points into the arena it
+// was compiled in
 typedef struct {
-    u16 value;
-    u16 mask;
+    chunk chunk;
+    bdd_manager *bdd;
+    bdd_ref root;
+} compiled_expression;
+
+// NOTE(fcasibu): all the state an evaluation touches. Engines share nothing, so separate ones can
+// compile and evaluate on different threads at the same time. The parser and intern pool belong
+// to the front end and the JIT buffer and VM to the back end, so one engine can also overlap
+// compiling one expression with evaluating another.
+typedef struct {
+    parser parser;
+    string_intern_array strings;
+
+    jit_buffer jit;
+    vm vm;
+
+    // NOTE(fcasibu): NULL unless the owner wants phase timings, the batch pipeline leaves it unset
+    // since both halves would write the same frame
+    profiler *profiler;
+} engine;
+
+// NOTE(fcasibu): Minimizer_Auto runs the exact minimizer while it is tractable
+typedef Enum(u8, minimizer){
+    Minimizer_Auto,
+    Minimizer_Exact,
+    Minimizer_Heuristic,
+};
+
+// NOTE(fcasibu): Columns_Sifted lays the table out in the variable order sifting picked for the
+// BDD instead of the order the variables first appear in
+typedef Enum(u8, column_order){
+    Columns_Source,
+    Columns_Sifted,
+};
+
+typedef struct {
+    u32 value;
+    u32 mask;
     b32 used;
 } implicant;
 
@@ -55,13 +136,4 @@ typedef struct {
     usize capacity;
 } implicants;
 
-internal u8
-GetTruthValue(const truth_table *table, u64 row_idx)
-{
-    Assert(row_idx < table->row_count);
-
-    u64 chunk = table->results.items[row_idx / 64];
-    return (u8)((chunk >> (row_idx % 64)) & 1);
-}
-
 #endif // VM_H